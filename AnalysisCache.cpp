@@ -0,0 +1,217 @@
+#include "AnalysisCache.h"
+#include "ToolInformation.h"
+#include "HPCPatternInstrASTTraversal.h"
+
+#include <map>
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+/* Increment if the format of the entries or the content of the logs changes */
+#define CACHE_FORMAT_VERSION 6
+
+static const char* CacheMagic = "PInTTUCache";
+
+
+
+AnalysisCache::AnalysisCache(std::string CacheDir, const clang::tooling::CompilationDatabase& Compilations, clang::tooling::ArgumentsAdjuster ArgsAdjuster) : Compilations(Compilations), NumHits(0), NumMisses(0), NumWriteFailures(0)
+{
+	this->CacheDir = CacheDir;
+	this->ArgsAdjuster = ArgsAdjuster;
+
+	llvm::sys::fs::create_directories(CacheDir);
+}
+
+/**
+ * @brief The name of the entry is the hash of everything that influences the translation unit, except for the file contents.
+ * This includes the analysis mode, since e.g. a log recorded with the prefilter lacks the patterns of a file whose instrumentation calls are hidden in macros.
+ *
+ * @param File The source file.
+ *
+ * @return The path of the entry in the cache directory.
+ **/
+std::string AnalysisCache::GetEntryPath(std::string File)
+{
+	llvm::SmallString<256> AbsoluteFile(File);
+	llvm::sys::fs::make_absolute(AbsoluteFile);
+
+	llvm::MD5 Hash;
+	Hash.update(PInTVersion);
+	Hash.update(llvm::StringRef("\0", 1));
+	Hash.update(HPCPatternInstrAction::GetAnalysisMode());
+	Hash.update(llvm::StringRef("\0", 1));
+	Hash.update(AbsoluteFile);
+
+	for (clang::tooling::CompileCommand& Command : Compilations.getCompileCommands(File))
+	{
+		Hash.update(llvm::StringRef("\0", 1));
+		Hash.update(Command.Directory);
+
+		clang::tooling::CommandLineArguments CommandLine = Command.CommandLine;
+		if (ArgsAdjuster)
+		{
+			CommandLine = ArgsAdjuster(CommandLine, Command.Filename);
+		}
+
+		for (std::string& Arg : CommandLine)
+		{
+			Hash.update(llvm::StringRef("\0", 1));
+			Hash.update(Arg);
+		}
+	}
+
+	llvm::MD5::MD5Result Result;
+	Hash.final(Result);
+
+	llvm::SmallString<256> EntryPath(CacheDir);
+	llvm::sys::path::append(EntryPath, Result.digest() + ".pintcache");
+	return EntryPath.str().str();
+}
+
+/**
+ * @brief Hashes the content of a file.
+ *
+ * @param Path The file.
+ *
+ * @return The hash value as hex string or an empty string if the file cannot be read.
+ **/
+std::string AnalysisCache::HashFileContent(std::string Path)
+{
+	llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer = llvm::MemoryBuffer::getFile(Path);
+
+	if (!Buffer)
+	{
+		return "";
+	}
+
+	llvm::MD5 Hash;
+	Hash.update((*Buffer)->getBuffer());
+
+	llvm::MD5::MD5Result Result;
+	Hash.final(Result);
+	return Result.digest().str().str();
+}
+
+bool AnalysisCache::Load(std::string File, std::vector<TranslationUnitLog>& Logs)
+{
+	llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer = llvm::MemoryBuffer::getFile(GetEntryPath(File));
+
+	if (!Buffer)
+	{
+		NumMisses++;
+		return false;
+	}
+
+	BinaryReader Reader((*Buffer)->getBuffer());
+
+	if (Reader.ReadString() != CacheMagic || Reader.ReadU32() != CACHE_FORMAT_VERSION)
+	{
+		NumMisses++;
+		return false;
+	}
+
+	/* Check that neither the main file nor one of the headers has changed */
+	uint32_t NumDependencies = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumDependencies && !Reader.HasFailed(); i++)
+	{
+		std::string Path = Reader.ReadString();
+		std::string ContentHash = Reader.ReadString();
+
+		if (Reader.HasFailed() || HashFileContent(Path) != ContentHash)
+		{
+			NumMisses++;
+			return false;
+		}
+	}
+
+	std::vector<TranslationUnitLog> CachedLogs;
+	uint32_t NumLogs = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumLogs && !Reader.HasFailed(); i++)
+	{
+		CachedLogs.push_back(TranslationUnitLog(""));
+
+		if (!TranslationUnitLog::Deserialize(Reader, CachedLogs.back()))
+		{
+			NumMisses++;
+			return false;
+		}
+	}
+
+	if (Reader.HasFailed() || !Reader.AtEnd())
+	{
+		NumMisses++;
+		return false;
+	}
+
+	for (TranslationUnitLog& Log : CachedLogs)
+	{
+		Logs.push_back(std::move(Log));
+	}
+
+	NumHits++;
+	return true;
+}
+
+bool AnalysisCache::Store(std::string File, std::vector<TranslationUnitLog>& Logs)
+{
+	/* A header can be included by several translation units of the file, hash it only once */
+	std::map<std::string, std::string> Dependencies;
+
+	for (TranslationUnitLog& Log : Logs)
+	{
+		for (std::string& Dependency : Log.GetDependencies())
+		{
+			if (Dependencies.find(Dependency) == Dependencies.end())
+			{
+				std::string ContentHash = HashFileContent(Dependency);
+
+				/* Do not store entries which could never be validated */
+				if (ContentHash.empty())
+				{
+					return true;
+				}
+
+				Dependencies[Dependency] = ContentHash;
+			}
+		}
+	}
+
+	BinaryWriter Writer;
+	Writer.WriteString(CacheMagic);
+	Writer.WriteU32(CACHE_FORMAT_VERSION);
+
+	Writer.WriteU32(Dependencies.size());
+	for (auto& Dependency : Dependencies)
+	{
+		Writer.WriteString(Dependency.first);
+		Writer.WriteString(Dependency.second);
+	}
+
+	Writer.WriteU32(Logs.size());
+	for (TranslationUnitLog& Log : Logs)
+	{
+		Log.Serialize(Writer);
+	}
+
+	/* The old entry stays in place if the new one cannot be written, it does not match the changed file anymore anyway */
+	if (!Writer.WriteToFile(GetEntryPath(File)))
+	{
+		NumWriteFailures++;
+		return false;
+	}
+
+	return true;
+}
+
+void AnalysisCache::PrintSummary()
+{
+	llvm::errs() << "Cache: " << NumHits << " translation units loaded, " << NumMisses << " analysed\n";
+
+	if (NumWriteFailures > 0)
+	{
+		llvm::errs() << "Cache: " << NumWriteFailures << " entries could not be written to " << CacheDir << ", these files are analysed again in the next run\n";
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "TranslationUnitLog.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+
+
+
+/**
+ * The AnalysisCache stores the TranslationUnitLogs of the analysed source files in a directory.
+ * An entry is found by a hash of the tool version, the analysis mode (see HPCPatternInstrAction::GetAnalysisMode()), the path of the source file and its (adjusted) compile commands.
+ * It is only used if the contents of the main file and all included headers still have the hash values recorded in the entry.
+ * Otherwise, the file has to be parsed again and the entry is overwritten.
+ */
+class AnalysisCache
+{
+public:
+	AnalysisCache(std::string CacheDir, const clang::tooling::CompilationDatabase& Compilations, clang::tooling::ArgumentsAdjuster ArgsAdjuster);
+
+	/**
+	 * @brief Looks up the logs of a source file.
+	 *
+	 * @param File The source file.
+	 * @param Logs The vector the cached logs are appended to.
+	 *
+	 * @return True if a valid entry was found.
+	 **/
+	bool Load(std::string File, std::vector<TranslationUnitLog>& Logs);
+
+	/**
+	 * @brief Stores the logs of a source file. The logs have to contain the dependencies of the translation units.
+	 * The entry is written to a temporary file which replaces the old entry only if it was written completely.
+	 * Entries which cannot be written, e.g. because the disk is full or the directory is read-only, are counted for the summary.
+	 *
+	 * @param File The source file.
+	 * @param Logs The logs of all compile commands of the file.
+	 *
+	 * @return False if the entry could not be written.
+	 **/
+	bool Store(std::string File, std::vector<TranslationUnitLog>& Logs);
+
+	unsigned int GetNumHits() { return NumHits; }
+
+	unsigned int GetNumMisses() { return NumMisses; }
+
+	unsigned int GetNumWriteFailures() { return NumWriteFailures; }
+
+	/**
+	 * @brief Prints the number of translation units loaded from the cache and analysed, and the number of entries which could not be written, to stderr.
+	 **/
+	void PrintSummary();
+
+private:
+	std::string GetEntryPath(std::string File);
+
+	static std::string HashFileContent(std::string Path);
+
+	std::string CacheDir;
+
+	const clang::tooling::CompilationDatabase& Compilations;
+
+	clang::tooling::ArgumentsAdjuster ArgsAdjuster;
+
+	/* Atomic, because the cache is shared by the worker threads */
+	std::atomic<unsigned int> NumHits;
+
+	std::atomic<unsigned int> NumMisses;
+
+	std::atomic<unsigned int> NumWriteFailures;
+};
@@ -0,0 +1,171 @@
+#include "AnalysisResult.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <algorithm>
+#include <iterator>
+
+#ifndef HPCERROR_H
+#include "HPCError.h"
+#endif
+
+/* Increment if the format of the fragment files or the content of the logs changes */
+#define FRAGMENT_FORMAT_VERSION 1
+
+static const char* FragmentMagic = "PInTResultFragment";
+
+
+
+AnalysisResult::AnalysisResult() : Files()
+{
+}
+
+void AnalysisResult::AddFile(uint32_t FileIdx, std::vector<TranslationUnitLog>&& Logs)
+{
+	auto Pos = std::lower_bound(Files.begin(), Files.end(), FileIdx, [](const FileResult& File, uint32_t Idx) { return File.FileIdx < Idx; });
+
+	if (Pos != Files.end() && Pos->FileIdx == FileIdx)
+	{
+		return;
+	}
+
+	FileResult File;
+	File.FileIdx = FileIdx;
+	File.Logs = std::move(Logs);
+	Files.insert(Pos, std::move(File));
+}
+
+void AnalysisResult::Merge(AnalysisResult&& Other)
+{
+	/* The workers take the files in ascending order, so the files of the other fragment usually follow the files of this one */
+	if (Files.empty() || Other.Files.empty() || Files.back().FileIdx < Other.Files.front().FileIdx)
+	{
+		Files.insert(Files.end(), std::make_move_iterator(Other.Files.begin()), std::make_move_iterator(Other.Files.end()));
+		Other.Files.clear();
+		return;
+	}
+
+	std::vector<FileResult> Merged;
+	Merged.reserve(Files.size() + Other.Files.size());
+
+	auto Mine = Files.begin();
+	auto Theirs = Other.Files.begin();
+
+	while (Mine != Files.end() || Theirs != Other.Files.end())
+	{
+		if (Theirs == Other.Files.end() || (Mine != Files.end() && Mine->FileIdx <= Theirs->FileIdx))
+		{
+			/* Both fragments contain the same file, keep only one of them */
+			if (Theirs != Other.Files.end() && Mine->FileIdx == Theirs->FileIdx)
+			{
+				Theirs++;
+			}
+			Merged.push_back(std::move(*Mine));
+			Mine++;
+		}
+		else
+		{
+			Merged.push_back(std::move(*Theirs));
+			Theirs++;
+		}
+	}
+
+	Files = std::move(Merged);
+	Other.Files.clear();
+}
+
+void AnalysisResult::Replay(AnalysisSession* Session)
+{
+	for (FileResult& File : Files)
+	{
+		for (TranslationUnitLog& Log : File.Logs)
+		{
+			Log.Replay(Session);
+		}
+	}
+}
+
+void AnalysisResult::Serialize(BinaryWriter& Writer)
+{
+	Writer.WriteU32(Files.size());
+	for (FileResult& File : Files)
+	{
+		Writer.WriteU32(File.FileIdx);
+		Writer.WriteU32(File.Logs.size());
+		for (TranslationUnitLog& Log : File.Logs)
+		{
+			Log.Serialize(Writer);
+		}
+	}
+}
+
+bool AnalysisResult::Deserialize(BinaryReader& Reader, AnalysisResult& Result)
+{
+	uint32_t NumFiles = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumFiles && !Reader.HasFailed(); i++)
+	{
+		uint32_t FileIdx = Reader.ReadU32();
+		uint32_t NumLogs = Reader.ReadU32();
+
+		std::vector<TranslationUnitLog> Logs;
+		for (uint32_t j = 0; j < NumLogs && !Reader.HasFailed(); j++)
+		{
+			TranslationUnitLog Log("");
+			if (!TranslationUnitLog::Deserialize(Reader, Log))
+			{
+				return false;
+			}
+			Logs.push_back(std::move(Log));
+		}
+
+		Result.AddFile(FileIdx, std::move(Logs));
+	}
+
+	return !Reader.HasFailed();
+}
+
+void AnalysisResult::Emit(std::string FileName, uint32_t ShardIdx, uint32_t NumShards, uint32_t NumFiles)
+{
+	BinaryWriter Writer;
+	Writer.WriteString(FragmentMagic);
+	Writer.WriteU32(FRAGMENT_FORMAT_VERSION);
+	Writer.WriteU32(ShardIdx);
+	Writer.WriteU32(NumShards);
+	Writer.WriteU32(NumFiles);
+	Serialize(Writer);
+
+	if (!Writer.WriteToFile(FileName))
+	{
+		throw ResultFragmentException(FileName, "the file could not be written");
+	}
+}
+
+void AnalysisResult::Load(std::string FileName, AnalysisResult& Result, uint32_t& ShardIdx, uint32_t& NumShards, uint32_t& NumFiles)
+{
+	llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer = llvm::MemoryBuffer::getFile(FileName);
+
+	if (!Buffer)
+	{
+		throw ResultFragmentException(FileName, Buffer.getError().message());
+	}
+
+	BinaryReader Reader((*Buffer)->getBuffer());
+
+	if (Reader.ReadString() != FragmentMagic)
+	{
+		throw ResultFragmentException(FileName, "the file is not a result fragment");
+	}
+
+	if (Reader.ReadU32() != FRAGMENT_FORMAT_VERSION)
+	{
+		throw ResultFragmentException(FileName, "the fragment was written by a different version of the tool");
+	}
+
+	ShardIdx = Reader.ReadU32();
+	NumShards = Reader.ReadU32();
+	NumFiles = Reader.ReadU32();
+
+	if (!Deserialize(Reader, Result) || ShardIdx >= NumShards)
+	{
+		throw ResultFragmentException(FileName, "the file is corrupt");
+	}
+}
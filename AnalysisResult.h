@@ -0,0 +1,99 @@
+#pragma once
+
+#include "TranslationUnitLog.h"
+#include "AnalysisSession.h"
+#include "Serialization.h"
+
+#include <cstdint>
+#include <vector>
+
+
+
+/**
+ * An AnalysisResult is a fragment of the results of an analysis: the TranslationUnitLogs of one or more source files.
+ * The logs of a file are only added once, afterwards a fragment is only combined with other fragments by Merge().
+ * Every file is identified by its position in the list of analysed files, so fragments can be built on worker threads, loaded from the AnalysisCache or read from files written by other processes.
+ * Merge() is associative and commutative: the fragments can be reduced in any order and grouping and the result contains the same files in the same order.
+ * The functions and pattern occurrences of the translation units are unified by their identifiers when the merged result is replayed into an AnalysisSession.
+ */
+class AnalysisResult
+{
+public:
+	AnalysisResult();
+
+	/**
+	 * @brief Adds the logs of a source file. A file can have several logs if the compilation database contains several compile commands for it.
+	 *
+	 * @param FileIdx The position of the file in the list of analysed files.
+	 * @param Logs The logs of the file.
+	 **/
+	void AddFile(uint32_t FileIdx, std::vector<TranslationUnitLog>&& Logs);
+
+	/**
+	 * @brief Moves the files of another fragment into this fragment.
+	 * If both fragments contain the same file, both contain the logs of the same translation units and only the logs of this fragment are kept.
+	 *
+	 * @param Other The other fragment, which is empty afterwards.
+	 **/
+	void Merge(AnalysisResult&& Other);
+
+	/**
+	 * @brief Replays the logs of all files into a session in the order of the list of analysed files.
+	 * This builds the same PatternGraph and CallTree as a serial analysis of the files. CallTree::setUpTree() still has to be called afterwards.
+	 *
+	 * @param Session The session.
+	 **/
+	void Replay(AnalysisSession* Session);
+
+	unsigned int GetNumFiles() { return Files.size(); }
+
+	/**
+	 * @brief Writes all files with their positions and logs.
+	 *
+	 * @param Writer The writer.
+	 **/
+	void Serialize(BinaryWriter& Writer);
+
+	/**
+	 * @brief Reads a fragment written by Serialize().
+	 *
+	 * @param Reader The reader.
+	 * @param Result An empty fragment the files are added to.
+	 *
+	 * @return False if the data is incomplete or corrupt.
+	 **/
+	static bool Deserialize(BinaryReader& Reader, AnalysisResult& Result);
+
+	/**
+	 * @brief Writes the fragment of one shard of a sharded analysis (see --shard) to a file.
+	 * Throws a ResultFragmentException if the file cannot be written.
+	 *
+	 * @param FileName The file name of the fragment.
+	 * @param ShardIdx The number of the shard.
+	 * @param NumShards The number of shards.
+	 * @param NumFiles The number of files in the complete file list.
+	 **/
+	void Emit(std::string FileName, uint32_t ShardIdx, uint32_t NumShards, uint32_t NumFiles);
+
+	/**
+	 * @brief Reads a fragment file written by Emit().
+	 * Throws a ResultFragmentException if the file cannot be read or is corrupt.
+	 *
+	 * @param FileName The file name of the fragment.
+	 * @param Result An empty fragment the files are added to.
+	 * @param ShardIdx Set to the number of the shard.
+	 * @param NumShards Set to the number of shards.
+	 * @param NumFiles Set to the number of files in the complete file list.
+	 **/
+	static void Load(std::string FileName, AnalysisResult& Result, uint32_t& ShardIdx, uint32_t& NumShards, uint32_t& NumFiles);
+
+private:
+	struct FileResult
+	{
+		uint32_t FileIdx;
+		std::vector<TranslationUnitLog> Logs;
+	};
+
+	/* Sorted by the positions of the files */
+	std::vector<FileResult> Files;
+};
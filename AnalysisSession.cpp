@@ -0,0 +1,101 @@
+#include "AnalysisSession.h"
+
+#include <iostream>
+#include "HPCError.h"
+
+
+
+AnalysisSession::AnalysisSession() : Graph(), ClTre(&Graph)
+{
+}
+
+void AnalysisSession::AddToPatternStack(PatternCodeRegion* PatternReg)
+{
+	PatternContext.push_back(PatternReg);
+}
+
+void AnalysisSession::AddToOnlyPatternStack(PatternCodeRegion* PatternReg)
+{
+	OnlyPatternContext.push_back(PatternReg);
+}
+
+PatternCodeRegion* AnalysisSession::GetTopPatternStack()
+{
+	if (!PatternContext.empty())
+	{
+		return PatternContext.back();
+	}
+		return NULL;
+}
+
+PatternCodeRegion* AnalysisSession::GetTopOnlyPatternStack()
+{
+	if (!OnlyPatternContext.empty())
+	{
+		return OnlyPatternContext.back();
+	}
+		return NULL;
+}
+
+void AnalysisSession::RemoveFromPatternStack(std::string ID)
+{
+	if (!PatternContext.empty())
+	{
+		try{
+			Atom IDAtom = AtomTable::Intern(ID);
+			int i = 0;
+			for(PatternCodeRegion* PatCodeReg : PatternContext){
+			if (IDAtom == PatCodeReg->GetIDAtom())
+			{
+				PatternContext.erase(PatternContext.begin()+i);
+				return;
+			}
+			i++;
+		}
+		throw TooManyEndsException(ID);
+		}
+		catch(TooManyEndsException& endsExeption){
+
+			endsExeption.what();
+			throw TerminateEarlyException();
+		}
+	}
+}
+
+void AnalysisSession::RemoveFromOnlyPatternStack(std::string ID){
+	if(!OnlyPatternContext.empty())
+	{
+		// we need to compare if the ID is the same as the ID of the Pattern that we inserted first in the stack
+		/*usually the WrongNestingException is encountered before this function*/
+		try{
+			Atom IDAtom = AtomTable::Intern(ID);
+			int i = 0;
+			for(PatternCodeRegion* PatCodeReg : OnlyPatternContext){
+				if (IDAtom == PatCodeReg->GetIDAtom())
+				{
+					OnlyPatternContext.erase(OnlyPatternContext.begin()+i);
+					return;
+				}
+				i++;
+			}
+			throw WrongNestingException(ID, ID);
+		}
+		catch(WrongNestingException& wrongNest){
+			std::cout << wrongNest.what() << std::endl;
+			throw TerminateEarlyException();
+		}
+	}
+	else{
+			//std::cout << "You probably added one end of a patten to much.\n" << ID << " ends outside of any Pattern." << std::endl;
+	}
+}
+
+void AnalysisSession::Reset()
+{
+	/* The call tree only refers to the nodes, which are released with the graph */
+	ClTre.Reset();
+	Graph.Reset();
+
+	PatternContext.clear();
+	OnlyPatternContext.clear();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "PatternGraph.h"
+#include "HPCParallelPattern.h"
+
+#include <string>
+#include <vector>
+
+class Halstead;
+
+
+
+/**
+ * The AnalysisSession owns the state of one analysis: the PatternGraph, the CallTree built on top of it and the pattern stacks.
+ * It is passed to the instrumentation handlers, the replay of the TranslationUnitLogs, the GraphSnapshot and the output explicitly,
+ * so several analyses can exist in the same process, one after another or at the same time.
+ * A session is not thread-safe. Translation units analysed on worker threads only record TranslationUnitLogs, which are replayed into the session afterwards (see RunParallelAnalysis()).
+ */
+class AnalysisSession
+{
+public:
+	AnalysisSession();
+
+	PatternGraph* GetGraph() { return &Graph; }
+
+	CallTree* GetCallTree() { return &ClTre; }
+
+	/**
+	 * @brief Add a PatternCodeRegion to the top of the pattern context stack.
+	 *
+	 * @param PatternReg Code Region to be placed on the stack.
+	 **/
+	void AddToPatternStack(PatternCodeRegion* PatternReg);
+
+	void AddToOnlyPatternStack(PatternCodeRegion* PatternReg);
+
+	/**
+	 * @brief Get the top of the pattern context stack.
+	 *
+	 * @return Top PatternCodeRegion or NULL if stack is empty.
+	 **/
+	PatternCodeRegion* GetTopPatternStack();
+
+	PatternCodeRegion* GetTopOnlyPatternStack();
+
+	/**
+	 * @brief Remove the first (i.e. outermost) code region with the given ID from the pattern context stack.
+	 * If the stack is not empty but contains no region with this ID, a TooManyEndsException is reported and a TerminateEarlyException is thrown. Nothing happens if the stack is empty.
+	 *
+	 * @param ID The suspected ID of the pattern context top.
+	 **/
+	void RemoveFromPatternStack(std::string ID);
+
+	void RemoveFromOnlyPatternStack(std::string ID);
+
+	/**
+	 * @brief Sets the Halstead statistic which is informed about the patterns with operators while the logs are replayed.
+	 *
+	 * @param Statistic The statistic or NULL.
+	 **/
+	void SetHalstead(Halstead* Statistic) { HalsteadStatistic = Statistic; }
+
+	Halstead* GetHalstead() { return HalsteadStatistic; }
+
+	/**
+	 * @brief Releases the graph and the call tree and empties the pattern stacks.
+	 * Afterwards another analysis can be run with this session.
+	 * All pointers to objects of the previous analysis are invalid after this call.
+	 **/
+	void Reset();
+
+private:
+	/* Prevent copies, the call tree refers to the graph */
+	AnalysisSession(const AnalysisSession&);
+	AnalysisSession& operator = (const AnalysisSession&);
+
+	PatternGraph Graph;
+
+	/* The call tree is declared after the graph, which owns its nodes */
+	CallTree ClTre;
+
+	/* The pattern stack is used to keep track of the nesting of patterns and functions */
+	std::vector<PatternCodeRegion*> PatternContext;
+	/* The OnlyPatternContext only keeps track of the nesting of patterns */
+	std::vector<PatternCodeRegion*> OnlyPatternContext;
+
+	Halstead* HalsteadStatistic = NULL;
+};
@@ -0,0 +1,41 @@
+#include "AtomTable.h"
+
+
+
+AtomTable::AtomTable()
+{
+	Strings.push_back(llvm::StringRef());
+}
+
+AtomTable& AtomTable::GetInstance()
+{
+	static AtomTable Table;
+	return Table;
+}
+
+Atom AtomTable::Intern(llvm::StringRef Str)
+{
+	if (Str.empty())
+	{
+		return 0;
+	}
+
+	AtomTable& Table = GetInstance();
+	std::lock_guard<std::mutex> Guard(Table.Lock);
+	auto Entry = Table.Atoms.insert(std::make_pair(Str, (Atom)Table.Strings.size()));
+
+	if (Entry.second)
+	{
+		/* The key is stored by the map, so it does not move when the map grows */
+		Table.Strings.push_back(Entry.first->getKey());
+	}
+
+	return Entry.first->getValue();
+}
+
+llvm::StringRef AtomTable::GetString(Atom A)
+{
+	AtomTable& Table = GetInstance();
+	std::lock_guard<std::mutex> Guard(Table.Lock);
+	return Table.Strings[A];
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+
+
+
+/**
+ * An Atom is the number of an interned string. Two atoms are equal if and only if their strings are equal.
+ * The atom 0 is the empty string.
+ */
+typedef uint32_t Atom;
+
+/**
+ * The AtomTable interns the pattern identifiers, pattern names and function names when the PatternGraph and the CallTree are built.
+ * Comparisons and hash keys use the atoms, the strings are only looked up for the output.
+ * There is one table for the whole process, so the atoms of all AnalysisSessions are compatible. It is guarded by a mutex, since sessions may be used on different threads.
+ * The strings are never released, so the references returned by GetString() stay valid until the end of the program.
+ */
+class AtomTable
+{
+public:
+	/**
+	 * @brief Returns the atom of a string. The string is copied into the table if it is not interned yet.
+	 *
+	 * @param Str The string.
+	 *
+	 * @return The atom of the string.
+	 **/
+	static Atom Intern(llvm::StringRef Str);
+
+	/**
+	 * @brief Returns the string of an atom.
+	 *
+	 * @param A An atom returned by Intern().
+	 *
+	 * @return The interned string.
+	 **/
+	static llvm::StringRef GetString(Atom A);
+
+private:
+	AtomTable();
+
+	static AtomTable& GetInstance();
+
+	std::mutex Lock;
+
+	llvm::StringMap<Atom, llvm::BumpPtrAllocator> Atoms;
+
+	/* The keys of the map, indexed by their atoms */
+	std::vector<llvm::StringRef> Strings;
+};
@@ -0,0 +1,67 @@
+#include "CodeRegionIndex.h"
+
+#include <algorithm>
+
+
+
+void CodeRegionIndex::AddRegion(unsigned Begin, unsigned End, unsigned Region)
+{
+	Intervals.push_back(Interval{Begin, End, Region});
+	MaxEnd.clear();
+}
+
+void CodeRegionIndex::Build()
+{
+	std::stable_sort(Intervals.begin(), Intervals.end(), [](const Interval& A, const Interval& B) { return A.Begin < B.Begin; });
+
+	MaxEnd.assign(Intervals.size(), 0);
+	BuildMaxEnd(0, Intervals.size());
+}
+
+unsigned CodeRegionIndex::BuildMaxEnd(size_t Lo, size_t Hi)
+{
+	if (Lo >= Hi)
+	{
+		return 0;
+	}
+
+	size_t Mid = Lo + (Hi - Lo) / 2;
+	unsigned Max = Intervals[Mid].End;
+	Max = std::max(Max, BuildMaxEnd(Lo, Mid));
+	Max = std::max(Max, BuildMaxEnd(Mid + 1, Hi));
+
+	MaxEnd[Mid] = Max;
+	return Max;
+}
+
+void CodeRegionIndex::FindContainingRegions(unsigned Offset, llvm::SmallVectorImpl<unsigned>& Regions) const
+{
+	/* Only the regions beginning before the offset can contain it */
+	size_t Limit = std::upper_bound(Intervals.begin(), Intervals.end(), Offset, [](unsigned Offset, const Interval& I) { return Offset < I.Begin; }) - Intervals.begin();
+
+	Find(0, Intervals.size(), Limit, Offset, Regions);
+}
+
+void CodeRegionIndex::Find(size_t Lo, size_t Hi, size_t Limit, unsigned Offset, llvm::SmallVectorImpl<unsigned>& Regions) const
+{
+	if (Lo >= Hi || Lo >= Limit)
+	{
+		return;
+	}
+
+	size_t Mid = Lo + (Hi - Lo) / 2;
+
+	if (MaxEnd[Mid] < Offset)
+	{
+		return;
+	}
+
+	Find(Lo, Mid, Limit, Offset, Regions);
+
+	if (Mid < Limit && Intervals[Mid].End >= Offset)
+	{
+		Regions.push_back(Intervals[Mid].Region);
+	}
+
+	Find(Mid + 1, Hi, Limit, Offset, Regions);
+}
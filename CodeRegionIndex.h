@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include "llvm/ADT/SmallVector.h"
+
+
+
+/**
+ * The CodeRegionIndex answers which pattern code regions of a source file contain a location.
+ * The regions are given as closed intervals of file offsets, from the beginning of the Pattern_Begin call to the end of the Pattern_End call.
+ * After Build(), the regions are sorted by their beginning and every entry knows the largest end in its subtree of an implicit binary search tree.
+ * A query then only descends into subtrees which can contain the location, so it takes O(log n) time for each region found.
+ * The regions may be nested or overlap.
+ */
+class CodeRegionIndex
+{
+public:
+	/**
+	 * @brief Adds a region to the index. The index has to be built again afterwards.
+	 *
+	 * @param Begin The offset of the beginning of the region.
+	 * @param End The offset of the end of the region.
+	 * @param Region An identifier of the region which is returned by queries.
+	 **/
+	void AddRegion(unsigned Begin, unsigned End, unsigned Region);
+
+	/**
+	 * @brief Sorts the regions and computes the largest ends of the subtrees.
+	 **/
+	void Build();
+
+	/**
+	 * @brief Finds all regions which contain the offset.
+	 *
+	 * @param Offset The file offset, e.g. of a statement.
+	 * @param Regions The identifiers of the containing regions are appended in the order of their beginning, i.e. the outermost region first.
+	 **/
+	void FindContainingRegions(unsigned Offset, llvm::SmallVectorImpl<unsigned>& Regions) const;
+
+	bool empty() const { return Intervals.empty(); }
+
+private:
+	struct Interval
+	{
+		unsigned Begin;
+		unsigned End;
+		unsigned Region;
+	};
+
+	unsigned BuildMaxEnd(size_t Lo, size_t Hi);
+
+	void Find(size_t Lo, size_t Hi, size_t Limit, unsigned Offset, llvm::SmallVectorImpl<unsigned>& Regions) const;
+
+	std::vector<Interval> Intervals;
+
+	/* The root of the subtree of the intervals [Lo, Hi) is the interval in the middle, MaxEnd holds the largest end of this subtree */
+	std::vector<unsigned> MaxEnd;
+};
@@ -2,35 +2,48 @@
 
 
 
+/* The first characters of the names of the design spaces are different modulo 7, so they are a perfect hash */
+#define DESIGN_SPACE_TABLE_SIZE 7
+
+struct DesignSpaceEntry
+{
+	const char* Name;
+	DesignSpace DesignSp;
+};
+
+static const DesignSpaceEntry DesignSpaceTable[DESIGN_SPACE_TABLE_SIZE] = {
+	{ "FindingConcurrency", FindingConcurrency }, /* 'F' = 70 */
+	{ NULL, Unknown },
+	{ "AlgorithmStructure", AlgorithmStructure }, /* 'A' = 65 */
+	{ "ImplementationMechanism", ImplementationMechanism }, /* 'I' = 73 */
+	{ NULL, Unknown },
+	{ NULL, Unknown },
+	{ "SupportingStructure", SupportingStructure } /* 'S' = 83 */
+};
+
 /**
  * @brief Converts a string to the corresponding design space enumeration value.
+ * The candidate is looked up with a perfect hash of the first character, so only one string is compared.
  *
  * @param str The string to translate.
  *
  * @return Corresponding design space.
  **/
-DesignSpace StrToDesignSpace(std::string str)
+DesignSpace StrToDesignSpace(llvm::StringRef str)
 {
-	if (!str.compare("FindingConcurrency")) 
-	{
-		return FindingConcurrency;
-	}
-	else if (!str.compare("AlgorithmStructure"))
-	{
-		return AlgorithmStructure;
-	}
-	else if (!str.compare("SupportingStructure"))
+	if (str.empty())
 	{
-		return SupportingStructure;	
-	}
-	else if (!str.compare("ImplementationMechanism"))
-	{
-		return ImplementationMechanism;
+		return Unknown;
 	}
-	else
+
+	const DesignSpaceEntry& Entry = DesignSpaceTable[(unsigned char)str[0] % DESIGN_SPACE_TABLE_SIZE];
+
+	if (Entry.Name != NULL && str == Entry.Name)
 	{
-		return Unknown;
+		return Entry.DesignSp;
 	}
+
+	return Unknown;
 }
 
 
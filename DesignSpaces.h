@@ -1,12 +1,13 @@
 #pragma once
 
 #include <string>
+#include "llvm/ADT/StringRef.h"
 
 
 
 /*! Design Spaces as defined in the literature. */
 enum DesignSpace { Unknown /*!< Use this to neglect design spaces completely or if the design space is really not categorisable. */, FindingConcurrency, AlgorithmStructure, SupportingStructure, ImplementationMechanism };
 
-DesignSpace StrToDesignSpace(std::string str);
+DesignSpace StrToDesignSpace(llvm::StringRef str);
 
 std::string DesignSpaceToStr(DesignSpace DesignSp);
@@ -0,0 +1,64 @@
+#include "FrozenPatternGraph.h"
+
+
+
+FrozenPatternGraph::FrozenPatternGraph(PatternGraph* Graph)
+{
+	for (PatternCodeRegion* CodeReg : Graph->GetAllPatternCodeRegions())
+	{
+		NodeIDs[CodeReg] = Nodes.size();
+		Nodes.push_back(CodeReg);
+		Kinds.push_back(PatternGraphNode::GNK_Pattern);
+		Patterns.push_back(CodeReg->GetPatternOccurrence()->GetPattern());
+	}
+
+	for (FunctionNode* Func : Graph->GetAllFunctions())
+	{
+		NodeIDs[Func] = Nodes.size();
+		Nodes.push_back(Func);
+		Kinds.push_back(PatternGraphNode::GNK_FnCall);
+		Patterns.push_back(NULL);
+	}
+
+	ChildOffsets.reserve(Nodes.size() + 1);
+	ParentOffsets.reserve(Nodes.size() + 1);
+
+	for (PatternGraphNode* Node : Nodes)
+	{
+		ChildOffsets.push_back(Children.size());
+		for (PatternGraphNode* Child : Node->GetChildren())
+		{
+			if (Child != NULL)
+			{
+				Children.push_back(GetNodeID(Child));
+			}
+		}
+
+		ParentOffsets.push_back(Parents.size());
+		for (PatternGraphNode* Parent : Node->GetParents())
+		{
+			if (Parent != NULL)
+			{
+				Parents.push_back(GetNodeID(Parent));
+			}
+		}
+	}
+
+	ChildOffsets.push_back(Children.size());
+	ParentOffsets.push_back(Parents.size());
+}
+
+FrozenPatternGraph::NodeID FrozenPatternGraph::GetNodeID(PatternGraphNode* Node) const
+{
+	return NodeIDs.lookup(Node);
+}
+
+PatternCodeRegion* FrozenPatternGraph::GetCodeRegion(NodeID ID) const
+{
+	if (IsCodeRegion(ID))
+	{
+		return static_cast<PatternCodeRegion*>(Nodes[ID]);
+	}
+
+	return NULL;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "PatternGraph.h"
+#include "HPCParallelPattern.h"
+
+#include <vector>
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+
+
+
+/**
+ * The FrozenPatternGraph is a read-only copy of the parent-child-relations of the PatternGraph in compressed sparse row format.
+ * It is created by PatternGraph::Freeze() after the call tree has been set up, because the graph does not change afterwards.
+ * Every PatternGraphNode gets a dense ID: first all PatternCodeRegions in the order of PatternGraph::GetAllPatternCodeRegions(), then all FunctionNodes in the order of PatternGraph::GetAllFunctions().
+ * The children and parents of all nodes are stored in two arrays, together with offsets into these arrays.
+ * The kind of each node and the pattern of each code region are stored in separate arrays, so traversals do not have to cast the nodes.
+ */
+class FrozenPatternGraph
+{
+public:
+	typedef unsigned NodeID;
+
+	/**
+	 * @brief Copies the relations of all nodes of the graph.
+	 *
+	 * @param Graph The PatternGraph.
+	 **/
+	FrozenPatternGraph(PatternGraph* Graph);
+
+	unsigned GetNumNodes() const { return Nodes.size(); }
+
+	/**
+	 * @brief Lookup of the dense ID of a node.
+	 *
+	 * @param Node A node of the graph.
+	 *
+	 * @return The ID of the node.
+	 **/
+	NodeID GetNodeID(PatternGraphNode* Node) const;
+
+	PatternGraphNode* GetNode(NodeID ID) const { return Nodes[ID]; }
+
+	bool IsCodeRegion(NodeID ID) const { return Kinds[ID] == PatternGraphNode::GNK_Pattern; }
+
+	/**
+	 * @brief Returns the code region with the given ID or NULL if the node is a FunctionNode.
+	 **/
+	PatternCodeRegion* GetCodeRegion(NodeID ID) const;
+
+	/**
+	 * @brief Returns the pattern of the code region with the given ID or NULL if the node is a FunctionNode.
+	 **/
+	HPCParallelPattern* GetPattern(NodeID ID) const { return Patterns[ID]; }
+
+	llvm::ArrayRef<NodeID> GetChildren(NodeID ID) const
+	{
+		return llvm::makeArrayRef(Children).slice(ChildOffsets[ID], ChildOffsets[ID + 1] - ChildOffsets[ID]);
+	}
+
+	llvm::ArrayRef<NodeID> GetParents(NodeID ID) const
+	{
+		return llvm::makeArrayRef(Parents).slice(ParentOffsets[ID], ParentOffsets[ID + 1] - ParentOffsets[ID]);
+	}
+
+private:
+	std::vector<PatternGraphNode*> Nodes;
+	std::vector<PatternGraphNode::GraphNodeKind> Kinds;
+	std::vector<HPCParallelPattern*> Patterns;
+
+	/* The neighbours of node i are stored at the indices [Offsets[i], Offsets[i+1]) */
+	std::vector<unsigned> ChildOffsets;
+	std::vector<NodeID> Children;
+	std::vector<unsigned> ParentOffsets;
+	std::vector<NodeID> Parents;
+
+	llvm::DenseMap<PatternGraphNode*, NodeID> NodeIDs;
+};
@@ -0,0 +1,583 @@
+#include "GraphSnapshot.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+
+#ifndef HPCERROR_H
+#include "HPCError.h"
+#endif
+
+/* Increment if the format of the snapshot changes */
+#define SNAPSHOT_FORMAT_VERSION 5
+
+static const char* SnapshotMagic = "PInTGraphSnapshot";
+
+/* Tags for references to PatternGraphNodes */
+#define GRAPHNODE_NULL 0
+#define GRAPHNODE_FUNCTION 1
+#define GRAPHNODE_REGION 2
+
+
+
+GraphSnapshot::GraphSnapshot()
+{
+}
+
+/**
+ * @brief Numbers all objects reachable from the PatternGraph and the CallTree of the session.
+ * Patterns, occurrences, code regions and functions are numbered in the order of the PatternGraph.
+ * CallTreeNodes are numbered in the order in which they are reachable from the vectors of the CallTree.
+ **/
+void GraphSnapshot::NumberObjects(AnalysisSession* Session)
+{
+	PatternGraph* Graph = Session->GetGraph();
+	CallTree* ClTre = Session->GetCallTree();
+
+	for (HPCParallelPattern* Pattern : Graph->Patterns)
+	{
+		PatternIndex[Pattern] = Patterns.size();
+		Patterns.push_back(Pattern);
+	}
+
+	for (PatternOccurrence* PatternOcc : Graph->PatternOccurrences)
+	{
+		OccurrenceIndex[PatternOcc] = Occurrences.size();
+		Occurrences.push_back(PatternOcc);
+	}
+
+	for (PatternCodeRegion* CodeReg : Graph->GetAllPatternCodeRegions())
+	{
+		GraphNodeIndex[CodeReg] = Regions.size();
+		Regions.push_back(CodeReg);
+	}
+
+	for (FunctionNode* Func : Graph->Functions)
+	{
+		GraphNodeIndex[Func] = Functions.size();
+		Functions.push_back(Func);
+	}
+
+	AddCallTreeNode(ClTre->RootNode);
+
+	for (CallTreeNode* Node : ClTre->DeclarationVector)
+	{
+		AddCallTreeNode(Node);
+	}
+
+	for (CallTreeNode* Node : ClTre->Pattern_EndVector)
+	{
+		AddCallTreeNode(Node);
+	}
+
+	for (PatternCodeRegion* CodeReg : Regions)
+	{
+		for (CallTreeNode* Node : CodeReg->CorrespondingCallTreeNodes)
+		{
+			AddCallTreeNode(Node);
+		}
+	}
+
+	for (FunctionNode* Func : Functions)
+	{
+		for (CallTreeNode* Node : Func->CorrespondingCallTreeNodes)
+		{
+			AddCallTreeNode(Node);
+		}
+	}
+
+	/* The vector grows while we iterate, so every node referenced by another node gets a number */
+	for (size_t i = 0; i < CallTreeNodes.size(); i++)
+	{
+		CallTreeNode* Node = CallTreeNodes[i];
+
+		AddCallTreeNode(Node->Caller);
+		AddCallTreeNode(Node->correspPatCallNode);
+
+		for (CallTreeNode* Callee : Node->Callees)
+		{
+			AddCallTreeNode(Callee);
+		}
+	}
+}
+
+void GraphSnapshot::AddCallTreeNode(CallTreeNode* Node)
+{
+	if (Node != NULL && CallTreeNodeIndex.find(Node) == CallTreeNodeIndex.end())
+	{
+		CallTreeNodeIndex[Node] = CallTreeNodes.size();
+		CallTreeNodes.push_back(Node);
+	}
+}
+
+void GraphSnapshot::WriteGraphNodeRef(BinaryWriter& Writer, PatternGraphNode* Node)
+{
+	if (Node == NULL)
+	{
+		Writer.WriteU8(GRAPHNODE_NULL);
+	}
+	else if (clang::isa<FunctionNode>(Node))
+	{
+		Writer.WriteU8(GRAPHNODE_FUNCTION);
+		Writer.WriteU32(GraphNodeIndex[Node]);
+	}
+	else
+	{
+		Writer.WriteU8(GRAPHNODE_REGION);
+		Writer.WriteU32(GraphNodeIndex[Node]);
+	}
+}
+
+void GraphSnapshot::WriteCallTreeNodeRef(BinaryWriter& Writer, CallTreeNode* Node)
+{
+	/* Zero is reserved for NULL */
+	if (Node == NULL)
+	{
+		Writer.WriteU32(0);
+	}
+	else
+	{
+		Writer.WriteU32(CallTreeNodeIndex[Node] + 1);
+	}
+}
+
+void GraphSnapshot::WriteRegionRefs(BinaryWriter& Writer, std::vector<PatternCodeRegion*>& Regions)
+{
+	Writer.WriteU32(Regions.size());
+	for (PatternCodeRegion* CodeReg : Regions)
+	{
+		WriteGraphNodeRef(Writer, CodeReg);
+	}
+}
+
+void GraphSnapshot::WriteCallTreeNodeRefs(BinaryWriter& Writer, std::vector<CallTreeNode*>& Nodes)
+{
+	Writer.WriteU32(Nodes.size());
+	for (CallTreeNode* Node : Nodes)
+	{
+		WriteCallTreeNodeRef(Writer, Node);
+	}
+}
+
+void GraphSnapshot::Emit(AnalysisSession* Session, std::string FileName, bool TreeIsSetUp)
+{
+	GraphSnapshot Snapshot;
+	Snapshot.NumberObjects(Session);
+
+	BinaryWriter Writer;
+	Writer.WriteString(SnapshotMagic);
+	Writer.WriteU32(SNAPSHOT_FORMAT_VERSION);
+	Writer.WriteBool(TreeIsSetUp);
+
+	/* First all objects with the data needed to construct them, then the relations between them */
+	Writer.WriteU32(Snapshot.Patterns.size());
+	for (HPCParallelPattern* Pattern : Snapshot.Patterns)
+	{
+		Writer.WriteU32(Pattern->DesignSp);
+		Writer.WriteString(AtomTable::GetString(Pattern->PatternName));
+		Writer.WriteU32(Pattern->numOfOperators);
+	}
+
+	Writer.WriteU32(Snapshot.Occurrences.size());
+	for (PatternOccurrence* PatternOcc : Snapshot.Occurrences)
+	{
+		Writer.WriteU32(Snapshot.PatternIndex[PatternOcc->GetPattern()]);
+		Writer.WriteString(AtomTable::GetString(PatternOcc->GetIDAtom()));
+	}
+
+	Writer.WriteU32(Snapshot.Regions.size());
+	for (PatternCodeRegion* CodeReg : Snapshot.Regions)
+	{
+		Writer.WriteU32(Snapshot.OccurrenceIndex[CodeReg->GetPatternOccurrence()]);
+	}
+
+	Writer.WriteU32(Snapshot.Functions.size());
+	for (FunctionNode* Func : Snapshot.Functions)
+	{
+		Writer.WriteString(AtomTable::GetString(Func->FnName));
+		Writer.WriteU64(Func->Hash);
+		Writer.WriteString(AtomTable::GetString(Func->USR));
+	}
+
+	Writer.WriteU32(Snapshot.CallTreeNodes.size());
+	for (CallTreeNode* Node : Snapshot.CallTreeNodes)
+	{
+		Writer.WriteU8(Node->NodeType);
+		Writer.WriteString(AtomTable::GetString(Node->ident.getIdentificationAtom()));
+		Writer.WriteU64(Node->ident.getIdentificationUnsigned());
+	}
+
+	/* Relations of the pattern graph */
+	for (HPCParallelPattern* Pattern : Snapshot.Patterns)
+	{
+		Writer.WriteU32(Pattern->Occurrences.size());
+		for (PatternOccurrence* PatternOcc : Pattern->Occurrences)
+		{
+			Writer.WriteU32(Snapshot.OccurrenceIndex[PatternOcc]);
+		}
+	}
+
+	for (PatternCodeRegion* CodeReg : Snapshot.Regions)
+	{
+		Writer.WriteU32(CodeReg->Parents.size());
+		for (PatternGraphNode* Parent : CodeReg->Parents)
+		{
+			Snapshot.WriteGraphNodeRef(Writer, Parent);
+		}
+
+		Writer.WriteU32(CodeReg->Children.size());
+		for (PatternGraphNode* Child : CodeReg->Children)
+		{
+			Snapshot.WriteGraphNodeRef(Writer, Child);
+		}
+
+		Snapshot.WriteRegionRefs(Writer, CodeReg->PatternParents);
+		Snapshot.WriteRegionRefs(Writer, CodeReg->PatternChildren);
+		Snapshot.WriteCallTreeNodeRefs(Writer, CodeReg->CorrespondingCallTreeNodes);
+
+		Writer.WriteU32(CodeReg->LinesOfCode);
+		CodeReg->StartPos.Serialize(Writer);
+		CodeReg->EndPos.Serialize(Writer);
+		Writer.WriteBool(CodeReg->isInMain);
+		Writer.WriteBool(CodeReg->isSuitedForNestingStatistics);
+		Writer.WriteU32(CodeReg->GetConnectedComponent());
+	}
+
+	for (FunctionNode* Func : Snapshot.Functions)
+	{
+		Writer.WriteU32(Func->Parents.size());
+		for (PatternGraphNode* Parent : Func->Parents)
+		{
+			Snapshot.WriteGraphNodeRef(Writer, Parent);
+		}
+
+		Writer.WriteU32(Func->Children.size());
+		for (PatternGraphNode* Child : Func->Children)
+		{
+			Snapshot.WriteGraphNodeRef(Writer, Child);
+		}
+
+		Snapshot.WriteRegionRefs(Writer, Func->PatternParents);
+		Snapshot.WriteRegionRefs(Writer, Func->PatternChildren);
+		Snapshot.WriteCallTreeNodeRefs(Writer, Func->CorrespondingCallTreeNodes);
+
+		Writer.WriteU32(Func->GetConnectedComponent());
+	}
+
+	PatternGraph* Graph = Session->GetGraph();
+	Snapshot.WriteGraphNodeRef(Writer, Graph->RootNode);
+
+	Writer.WriteU32(Graph->OnlyPatternRootNodes.size());
+	for (PatternGraphNode* Node : Graph->OnlyPatternRootNodes)
+	{
+		Snapshot.WriteGraphNodeRef(Writer, Node);
+	}
+
+	/* Relations of the call tree */
+	for (CallTreeNode* Node : Snapshot.CallTreeNodes)
+	{
+		Snapshot.WriteCallTreeNodeRef(Writer, Node->Caller);
+		Snapshot.WriteGraphNodeRef(Writer, Node->CorrespondingNode);
+
+		Snapshot.WriteCallTreeNodeRefs(Writer, Node->Callees);
+
+		Writer.WriteU32(Node->locTillPatternEnd);
+		Node->Position.Serialize(Writer);
+		Snapshot.WriteCallTreeNodeRef(Writer, Node->correspPatCallNode);
+		Writer.WriteBool(Node->isSuitedForNestingStatistics);
+	}
+
+	CallTree* ClTre = Session->GetCallTree();
+	Snapshot.WriteCallTreeNodeRef(Writer, ClTre->RootNode);
+	Snapshot.WriteCallTreeNodeRefs(Writer, ClTre->DeclarationVector);
+	Snapshot.WriteCallTreeNodeRefs(Writer, ClTre->Pattern_EndVector);
+
+	if (!Writer.WriteToFile(FileName))
+	{
+		throw GraphSnapshotException(FileName, "the file could not be written");
+	}
+}
+
+PatternGraphNode* GraphSnapshot::ReadGraphNodeRef(BinaryReader& Reader)
+{
+	uint8_t Tag = Reader.ReadU8();
+
+	if (Tag == GRAPHNODE_NULL)
+	{
+		return NULL;
+	}
+
+	uint32_t Index = Reader.ReadU32();
+
+	if (Tag == GRAPHNODE_FUNCTION && Index < Functions.size())
+	{
+		return Functions[Index];
+	}
+	else if (Tag == GRAPHNODE_REGION && Index < Regions.size())
+	{
+		return Regions[Index];
+	}
+
+	InvalidRef = true;
+	return NULL;
+}
+
+CallTreeNode* GraphSnapshot::ReadCallTreeNodeRef(BinaryReader& Reader)
+{
+	uint32_t Index = Reader.ReadU32();
+
+	if (Index == 0)
+	{
+		return NULL;
+	}
+
+	if (Index > CallTreeNodes.size())
+	{
+		InvalidRef = true;
+		return NULL;
+	}
+
+	return CallTreeNodes[Index - 1];
+}
+
+PatternCodeRegion* GraphSnapshot::ReadRegionRef(BinaryReader& Reader)
+{
+	PatternGraphNode* Node = ReadGraphNodeRef(Reader);
+
+	if (Node != NULL && !clang::isa<PatternCodeRegion>(Node))
+	{
+		InvalidRef = true;
+		return NULL;
+	}
+
+	return clang::cast_or_null<PatternCodeRegion>(Node);
+}
+
+std::vector<PatternCodeRegion*> GraphSnapshot::ReadRegionRefs(BinaryReader& Reader)
+{
+	std::vector<PatternCodeRegion*> Result;
+
+	uint32_t NumRegions = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumRegions && !Reader.HasFailed() && !InvalidRef; i++)
+	{
+		Result.push_back(ReadRegionRef(Reader));
+	}
+
+	return Result;
+}
+
+std::vector<CallTreeNode*> GraphSnapshot::ReadCallTreeNodeRefs(BinaryReader& Reader)
+{
+	std::vector<CallTreeNode*> Result;
+
+	uint32_t NumNodes = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumNodes && !Reader.HasFailed() && !InvalidRef; i++)
+	{
+		Result.push_back(ReadCallTreeNodeRef(Reader));
+	}
+
+	return Result;
+}
+
+bool GraphSnapshot::Load(AnalysisSession* Session, std::string FileName)
+{
+	llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer = llvm::MemoryBuffer::getFile(FileName);
+
+	if (!Buffer)
+	{
+		throw GraphSnapshotException(FileName, Buffer.getError().message());
+	}
+
+	BinaryReader Reader((*Buffer)->getBuffer());
+
+	if (Reader.ReadString() != SnapshotMagic)
+	{
+		throw GraphSnapshotException(FileName, "the file is not a graph snapshot");
+	}
+
+	if (Reader.ReadU32() != SNAPSHOT_FORMAT_VERSION)
+	{
+		throw GraphSnapshotException(FileName, "the snapshot was written by a different version of the tool");
+	}
+
+	bool TreeIsSetUp = Reader.ReadBool();
+
+	GraphSnapshot Snapshot;
+	PatternGraph* Graph = Session->GetGraph();
+	CallTree* ClTre = Session->GetCallTree();
+
+	/* Create all objects */
+	uint32_t NumPatterns = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumPatterns && !Reader.HasFailed(); i++)
+	{
+		DesignSpace DesignSp = (DesignSpace)Reader.ReadU32();
+		std::string PatternName = Reader.ReadString();
+
+		HPCParallelPattern* Pattern = Graph->CreatePattern(DesignSp, AtomTable::Intern(PatternName));
+		Pattern->numOfOperators = Reader.ReadU32();
+		Snapshot.Patterns.push_back(Pattern);
+	}
+
+	uint32_t NumOccurrences = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumOccurrences && !Reader.HasFailed(); i++)
+	{
+		uint32_t PatternIdx = Reader.ReadU32();
+		std::string ID = Reader.ReadString();
+
+		if (PatternIdx >= Snapshot.Patterns.size())
+		{
+			throw GraphSnapshotException(FileName, "the file is corrupt");
+		}
+
+		Snapshot.Occurrences.push_back(Graph->CreatePatternOccurrence(Snapshot.Patterns[PatternIdx], AtomTable::Intern(ID)));
+	}
+
+	uint32_t NumRegions = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumRegions && !Reader.HasFailed(); i++)
+	{
+		uint32_t OccurrenceIdx = Reader.ReadU32();
+
+		if (OccurrenceIdx >= Snapshot.Occurrences.size())
+		{
+			throw GraphSnapshotException(FileName, "the file is corrupt");
+		}
+
+		PatternOccurrence* PatternOcc = Snapshot.Occurrences[OccurrenceIdx];
+		PatternCodeRegion* CodeReg = Graph->CreatePatternCodeRegion(PatternOcc);
+		PatternOcc->AddCodeRegion(CodeReg);
+		Snapshot.Regions.push_back(CodeReg);
+	}
+
+	uint32_t NumFunctions = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumFunctions && !Reader.HasFailed(); i++)
+	{
+		std::string FnName = Reader.ReadString();
+		uint64_t Hash = Reader.ReadU64();
+		Atom USR = AtomTable::Intern(Reader.ReadString());
+		Snapshot.Functions.push_back(Graph->CreateFunctionNode(FnName, Hash, USR));
+	}
+
+	uint32_t NumCallTreeNodes = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumCallTreeNodes && !Reader.HasFailed(); i++)
+	{
+		CallTreeNodeType NodeType = (CallTreeNodeType)Reader.ReadU8();
+		std::string IdentificationString = Reader.ReadString();
+		uint64_t IdentificationUnsigned = Reader.ReadU64();
+
+		Identification Ident;
+		if (NodeType == Pattern_Begin || NodeType == Pattern_End)
+		{
+			Ident = Identification(NodeType, IdentificationString);
+		}
+		else
+		{
+			Ident = Identification(NodeType, IdentificationUnsigned);
+		}
+
+		Snapshot.CallTreeNodes.push_back(Graph->CreateCallTreeNode(NodeType, Ident));
+	}
+
+	/* Restore the relations of the pattern graph */
+	for (HPCParallelPattern* Pattern : Snapshot.Patterns)
+	{
+		uint32_t NumPatternOccs = Reader.ReadU32();
+		for (uint32_t i = 0; i < NumPatternOccs && !Reader.HasFailed(); i++)
+		{
+			uint32_t OccurrenceIdx = Reader.ReadU32();
+
+			if (OccurrenceIdx >= Snapshot.Occurrences.size())
+			{
+				throw GraphSnapshotException(FileName, "the file is corrupt");
+			}
+
+			Pattern->AddOccurrence(Snapshot.Occurrences[OccurrenceIdx]);
+		}
+	}
+
+	for (PatternCodeRegion* CodeReg : Snapshot.Regions)
+	{
+		uint32_t NumParents = Reader.ReadU32();
+		for (uint32_t i = 0; i < NumParents && !Reader.HasFailed(); i++)
+		{
+			CodeReg->Parents.push_back(Snapshot.ReadGraphNodeRef(Reader));
+		}
+
+		uint32_t NumChildren = Reader.ReadU32();
+		for (uint32_t i = 0; i < NumChildren && !Reader.HasFailed(); i++)
+		{
+			CodeReg->Children.push_back(Snapshot.ReadGraphNodeRef(Reader));
+		}
+
+		CodeReg->PatternParents = Snapshot.ReadRegionRefs(Reader);
+		CodeReg->PatternChildren = Snapshot.ReadRegionRefs(Reader);
+		CodeReg->CorrespondingCallTreeNodes = Snapshot.ReadCallTreeNodeRefs(Reader);
+
+		CodeReg->LinesOfCode = Reader.ReadU32();
+		CodeReg->StartPos = SourcePosition::Deserialize(Reader);
+		CodeReg->EndPos = SourcePosition::Deserialize(Reader);
+		CodeReg->isInMain = Reader.ReadBool();
+		CodeReg->isSuitedForNestingStatistics = Reader.ReadBool();
+		CodeReg->SetConnectedComponent(Reader.ReadU32());
+	}
+
+	for (FunctionNode* Func : Snapshot.Functions)
+	{
+		uint32_t NumParents = Reader.ReadU32();
+		for (uint32_t i = 0; i < NumParents && !Reader.HasFailed(); i++)
+		{
+			Func->Parents.push_back(Snapshot.ReadGraphNodeRef(Reader));
+		}
+
+		uint32_t NumChildren = Reader.ReadU32();
+		for (uint32_t i = 0; i < NumChildren && !Reader.HasFailed(); i++)
+		{
+			Func->Children.push_back(Snapshot.ReadGraphNodeRef(Reader));
+		}
+
+		Func->PatternParents = Snapshot.ReadRegionRefs(Reader);
+		Func->PatternChildren = Snapshot.ReadRegionRefs(Reader);
+		Func->CorrespondingCallTreeNodes = Snapshot.ReadCallTreeNodeRefs(Reader);
+
+		Func->SetConnectedComponent(Reader.ReadU32());
+	}
+
+	Graph->Patterns = Snapshot.Patterns;
+	Graph->PatternOccurrences = Snapshot.Occurrences;
+	Graph->Functions = Snapshot.Functions;
+	Graph->RebuildIndices();
+	Graph->RootNode = Snapshot.ReadGraphNodeRef(Reader);
+
+	uint32_t NumOnlyPatternRootNodes = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumOnlyPatternRootNodes && !Reader.HasFailed(); i++)
+	{
+		Graph->OnlyPatternRootNodes.push_back(Snapshot.ReadGraphNodeRef(Reader));
+	}
+
+	/* Restore the relations of the call tree */
+	for (CallTreeNode* Node : Snapshot.CallTreeNodes)
+	{
+		Node->Caller = Snapshot.ReadCallTreeNodeRef(Reader);
+		Node->CorrespondingNode = Snapshot.ReadGraphNodeRef(Reader);
+
+		for (CallTreeNode* Callee : Snapshot.ReadCallTreeNodeRefs(Reader))
+		{
+			Node->insertCallee(Callee);
+		}
+
+		Node->locTillPatternEnd = Reader.ReadU32();
+		Node->Position = SourcePosition::Deserialize(Reader);
+		Node->correspPatCallNode = Snapshot.ReadCallTreeNodeRef(Reader);
+		Node->isSuitedForNestingStatistics = Reader.ReadBool();
+	}
+
+	ClTre->RootNode = Snapshot.ReadCallTreeNodeRef(Reader);
+	ClTre->DeclarationVector = Snapshot.ReadCallTreeNodeRefs(Reader);
+	ClTre->Pattern_EndVector = Snapshot.ReadCallTreeNodeRefs(Reader);
+
+	if (Reader.HasFailed() || !Reader.AtEnd() || Snapshot.InvalidRef)
+	{
+		throw GraphSnapshotException(FileName, "the file is corrupt");
+	}
+
+	ClTre->RebuildDeclIndices();
+
+	return TreeIsSetUp;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "HPCParallelPattern.h"
+#include "PatternGraph.h"
+#include "AnalysisSession.h"
+#include "Serialization.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+
+/**
+ * The GraphSnapshot writes the PatternGraph and the CallTree of an AnalysisSession to a binary file after the analysis and restores them without parsing the source code again.
+ * This way the statistics and the tree printers can be run on a snapshot as often as needed.
+ * All objects are numbered in the order of the vectors of the PatternGraph and the CallTree, pointers are stored as these numbers.
+ * The positions of the code regions and call tree nodes are stored as SourcePositions, which do not depend on the SourceManager of the translation unit.
+ */
+class GraphSnapshot
+{
+public:
+	/**
+	 * @brief Writes the PatternGraph and the CallTree of a session to a file.
+	 *
+	 * @param Session The session.
+	 * @param FileName The file name of the snapshot.
+	 * @param TreeIsSetUp True if CallTree::appendAllDeclToCallTree() and CallTree::setUpTree() have been called, i.e. the call tree can be printed.
+	 **/
+	static void Emit(AnalysisSession* Session, std::string FileName, bool TreeIsSetUp);
+
+	/**
+	 * @brief Restores the PatternGraph and the CallTree of a session from a file. Both have to be empty.
+	 * Throws a GraphSnapshotException if the file cannot be read or is corrupt.
+	 *
+	 * @param Session The session.
+	 * @param FileName The file name of the snapshot.
+	 *
+	 * @return True if the call tree in the snapshot is set up (see GraphSnapshot::Emit()).
+	 **/
+	static bool Load(AnalysisSession* Session, std::string FileName);
+
+private:
+	GraphSnapshot();
+
+	void NumberObjects(AnalysisSession* Session);
+
+	void AddCallTreeNode(CallTreeNode* Node);
+
+	void WriteGraphNodeRef(BinaryWriter& Writer, PatternGraphNode* Node);
+
+	void WriteCallTreeNodeRef(BinaryWriter& Writer, CallTreeNode* Node);
+
+	void WriteRegionRefs(BinaryWriter& Writer, std::vector<PatternCodeRegion*>& Regions);
+
+	void WriteCallTreeNodeRefs(BinaryWriter& Writer, std::vector<CallTreeNode*>& Nodes);
+
+	PatternGraphNode* ReadGraphNodeRef(BinaryReader& Reader);
+
+	CallTreeNode* ReadCallTreeNodeRef(BinaryReader& Reader);
+
+	PatternCodeRegion* ReadRegionRef(BinaryReader& Reader);
+
+	std::vector<PatternCodeRegion*> ReadRegionRefs(BinaryReader& Reader);
+
+	std::vector<CallTreeNode*> ReadCallTreeNodeRefs(BinaryReader& Reader);
+
+	std::vector<HPCParallelPattern*> Patterns;
+	std::vector<PatternOccurrence*> Occurrences;
+	std::vector<PatternCodeRegion*> Regions;
+	std::vector<FunctionNode*> Functions;
+	std::vector<CallTreeNode*> CallTreeNodes;
+
+	std::map<HPCParallelPattern*, uint32_t> PatternIndex;
+	std::map<PatternOccurrence*, uint32_t> OccurrenceIndex;
+	std::map<PatternGraphNode*, uint32_t> GraphNodeIndex;
+	std::map<CallTreeNode*, uint32_t> CallTreeNodeIndex;
+
+	/* Set if a reference in the file points to a non-existing object */
+	bool InvalidRef = false;
+};
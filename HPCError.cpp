@@ -71,3 +71,39 @@ void missingPatternEnd::printPatternWithNoEnd() const{
     }
   }
 };
+
+MalformedPatternDescriptorException::MalformedPatternDescriptorException(std::string Descriptor, size_t Offset, std::string Reason){
+  /* The descriptor is printed with a marker below the offending character */
+  this->Message = "\033[31mMalformed argument of a pattern begin at offset " + std::to_string(Offset) + ": " + Reason + "\033[0m\n";
+  this->Message += "  \"" + Descriptor + "\"\n";
+  this->Message += "   " + std::string(Offset, ' ') + "^\n";
+  this->Message += "The argument has to be \"DesignSpace PatternName Identifier\", e.g. \"AlgorithmStructure Pipeline P1\".\n";
+};
+
+const char* MalformedPatternDescriptorException::what() const throw(){
+  return this->Message.c_str();
+};
+
+GraphSnapshotException::GraphSnapshotException(std::string FileName, std::string Reason){
+  this->Message = "\033[31mCould not use the graph snapshot " + FileName + ": " + Reason + "\033[0m\n";
+};
+
+const char* GraphSnapshotException::what() const throw(){
+  return this->Message.c_str();
+};
+
+FunctionHashCollisionException::FunctionHashCollisionException(std::string FirstUSR, std::string SecondUSR){
+  this->Message = "\033[31mThe functions " + FirstUSR + " and " + SecondUSR + " have the same hash value, so calls between translation units cannot be linked correctly.\033[0m\n";
+};
+
+const char* FunctionHashCollisionException::what() const throw(){
+  return this->Message.c_str();
+};
+
+ResultFragmentException::ResultFragmentException(std::string FileName, std::string Reason){
+  this->Message = "\033[31mCould not use the result fragment " + FileName + ": " + Reason + "\033[0m\n";
+};
+
+const char* ResultFragmentException::what() const throw(){
+  return this->Message.c_str();
+};
@@ -73,3 +73,35 @@ private:
   std::vector<PatternCodeRegion*> PatternVector;
 
 };
+
+class MalformedPatternDescriptorException: public PInTRuntimeException{
+public:
+  MalformedPatternDescriptorException(std::string Descriptor, size_t Offset, std::string Reason);
+  const char* what() const throw();
+private:
+  std::string Message;
+};
+
+class GraphSnapshotException: public PInTRuntimeException{
+public:
+  GraphSnapshotException(std::string FileName, std::string Reason);
+  const char* what() const throw();
+private:
+  std::string Message;
+};
+
+class FunctionHashCollisionException: public PInTRuntimeException{
+public:
+  FunctionHashCollisionException(std::string FirstUSR, std::string SecondUSR);
+  const char* what() const throw();
+private:
+  std::string Message;
+};
+
+class ResultFragmentException: public PInTRuntimeException{
+public:
+  ResultFragmentException(std::string FileName, std::string Reason);
+  const char* what() const throw();
+private:
+  std::string Message;
+};
@@ -11,7 +11,7 @@
 /*
  * HPC Parallel Pattern Class Functions
  */
-HPCParallelPattern::HPCParallelPattern(DesignSpace DesignSp, std::string PatternName)
+HPCParallelPattern::HPCParallelPattern(DesignSpace DesignSp, Atom PatternName)
 {
 	this->DesignSp = DesignSp;
 	this->PatternName = PatternName;
@@ -25,7 +25,7 @@ void HPCParallelPattern::Print()
 {
 	std::cout << "Pattern Info" << std::endl;
 	std::cout << "Pattern Design Space: " << DesignSpaceToStr(this->DesignSp) << std::endl;
-	std::cout << "Pattern Name: " << this->PatternName << std::endl;
+	std::cout << "Pattern Name: " << GetPatternName() << std::endl;
 	std::cout << this->Occurrences.size() << " Occurrences." << std::endl;
 }
 
@@ -34,7 +34,7 @@ void HPCParallelPattern::Print()
  **/
 void HPCParallelPattern::PrintShort()
 {
-	std::cout << "\033[33m" << DesignSpaceToStr(this->DesignSp) << "\033[0m" << this->PatternName;
+	std::cout << "\033[33m" << DesignSpaceToStr(this->DesignSp) << "\033[0m" << GetPatternName();
 }
 
 void HPCParallelPattern::AddOccurrence(PatternOccurrence* Occurrence)
@@ -66,7 +66,7 @@ int HPCParallelPattern::GetTotalLinesOfCode()
  **/
 bool HPCParallelPattern::Equals(HPCParallelPattern* Pattern)
 {
-	if (this->DesignSp == Pattern->GetDesignSpace() && !this->PatternName.compare(Pattern->GetPatternName()))
+	if (this->DesignSp == Pattern->GetDesignSpace() && this->PatternName == Pattern->GetPatternNameAtom())
 	{
 		return true;
 	}
@@ -74,39 +74,24 @@ bool HPCParallelPattern::Equals(HPCParallelPattern* Pattern)
 	return false;
 }
 
-std::vector<PatternOccurrence*> HPCParallelPattern::GetOccurrences() {
-	if(!this->Occurrences.empty()){
-	  	return this->Occurrences;
-	}
-	else{
-		  return std::vector<PatternOccurrence*>();
-	}
-}
-
 /**
  * @brief Get all code regions from all pattern occurrences.
  *
- * @return Return pointers to all PatternCodeRegion objects from all PatternOccurrence objects.
+ * @return A range over all PatternCodeRegion objects from all PatternOccurrence objects.
  **/
-std::vector<PatternCodeRegion*> HPCParallelPattern::GetCodeRegions()
+CodeRegionRange HPCParallelPattern::GetCodeRegions()
 {
-	std::vector<PatternCodeRegion*> CodeRegions = std::vector<PatternCodeRegion*>();
-
-	for (PatternOccurrence* PatternOcc : this->GetOccurrences())
-	{
-		for (PatternCodeRegion* CodeReg : PatternOcc->GetCodeRegions())
-		{
-			CodeRegions.push_back(CodeReg);
-		}
-	}
-
-	return CodeRegions;
+	return CodeRegionRange(this->Occurrences);
 }
 
 void HPCParallelPattern::incrementNumOfOperators(){
 	this->numOfOperators++;
 }
 
+void HPCParallelPattern::AddNumOfOperators(int Num){
+	this->numOfOperators += Num;
+}
+
 int HPCParallelPattern::GetNumOfOperators(){
 	return this->numOfOperators;
 }
@@ -114,7 +99,7 @@ int HPCParallelPattern::GetNumOfOperators(){
 /*
  * Pattern Occurrence Class Functions
  */
-PatternOccurrence::PatternOccurrence(HPCParallelPattern* Pattern, std::string ID)
+PatternOccurrence::PatternOccurrence(HPCParallelPattern* Pattern, Atom ID)
 {
 	this->Pattern = Pattern;
 	this->ID = ID;
@@ -152,7 +137,7 @@ int PatternOccurrence::GetTotalLinesOfCode()
  **/
 bool PatternOccurrence::Equals(PatternOccurrence* PatternOcc)
 {
-	if (!this->ID.compare(PatternOcc->GetID()) && this->Pattern->Equals(PatternOcc->GetPattern()))
+	if (this->ID == PatternOcc->GetIDAtom() && this->Pattern->Equals(PatternOcc->GetPattern()))
 	{
 		return true;
 	}
@@ -174,8 +159,6 @@ void PatternOccurrence::Print()
 /*
  * Pattern Code Region Class Functions
  */
-PatternCodeRegion::~PatternCodeRegion(){std::cout << "Deleted CodeRegion" << '\n';}
-
 PatternCodeRegion::PatternCodeRegion(PatternOccurrence* PatternOcc) : PatternGraphNode(GNK_Pattern), Parents(), Children()
 {
 	this->PatternOcc = PatternOcc;
@@ -190,7 +173,7 @@ void PatternCodeRegion::AddChild(PatternGraphNode* Child)
 		for(PatternGraphNode* PatFor : this->Children){
 			if(PatternCodeRegion* PatRegFor = clang::dyn_cast<PatternCodeRegion>(PatFor))
 			{
-					if(PatRegFor->GetID()== ChildCodeReg->GetID()) return;
+					if(PatRegFor->GetIDAtom() == ChildCodeReg->GetIDAtom()) return;
 			}
 		}
 	}
@@ -217,7 +200,7 @@ void PatternCodeRegion::AddParent(PatternGraphNode* Parent)
 		for(PatternGraphNode* PatFor : this->Parents){
 			if(PatternCodeRegion* PatRegFor = clang::dyn_cast<PatternCodeRegion>(PatFor))
 			{
-					if(PatRegFor->GetID()== ParentCodeReg->GetID()) return;
+					if(PatRegFor->GetIDAtom() == ParentCodeReg->GetIDAtom()) return;
 			}
 		}
 	}
@@ -239,7 +222,7 @@ void PatternCodeRegion::AddOnlyPatternChild(PatternGraphNode* PatChild)
 		*/
 		PatternCodeRegion* PatternChild = clang::dyn_cast<PatternCodeRegion>(PatChild);
 		for(PatternCodeRegion* PatRegFor : this->PatternChildren){
-			if(PatRegFor->GetID() == PatternChild->GetID()) return;
+			if(PatRegFor->GetIDAtom() == PatternChild->GetIDAtom()) return;
 		}
 		this->PatternChildren.push_back(PatternChild);
 
@@ -250,7 +233,7 @@ void PatternCodeRegion::AddOnlyPatternParent(PatternGraphNode* PatParent)
 	*/
 	PatternCodeRegion* PatternParent = clang::dyn_cast<PatternCodeRegion>(PatParent);
 	for(PatternCodeRegion* PatRegFor : this->PatternParents){
-		if(PatRegFor->GetID() == PatternParent->GetID()) return;
+		if(PatRegFor->GetIDAtom() == PatternParent->GetIDAtom()) return;
 	}
 	this->PatternParents.push_back(PatternParent);
 }
@@ -272,15 +255,6 @@ void PatternCodeRegion::SetLastLine(int LastLine)
 	this->LinesOfCode = (LastLine - this->LinesOfCode) - 1;
 }
 
-void PatternCodeRegion::SetStartSourceLoc(clang::SourceLocation StartLoc)
-{
-	this->StartSLocation = StartLoc;
-}
-
-void PatternCodeRegion::SetEndSourceLoc(clang::SourceLocation EndLoc){
-	this->EndSLocation = EndLoc;
-}
-
 /**
  * @brief Print the lines of code plus all information from PatternOccurrence::Print().
  **/
@@ -290,14 +264,6 @@ void PatternCodeRegion::Print()
 	std::cout << this->GetLinesOfCode() << " lines of code." << std::endl;
 }
 
-clang::SourceLocation PatternCodeRegion::GetStartLoc(){
-	return this->StartSLocation;
-}
-
-clang::SourceLocation PatternCodeRegion::GetEndLoc(){
-	return this->EndSLocation;
-}
-
 bool PatternCodeRegion::HasNoPatternParents(){
 	if(this->PatternParents.size()){
 		return false;
@@ -312,7 +278,7 @@ bool PatternCodeRegion::HasNoPatternChildren(){
 	return true;
 }
 
-void PatternCodeRegion::PrintVecOfPattern(std::vector<PatternCodeRegion*> RegionVec){
+void PatternCodeRegion::PrintVecOfPattern(llvm::ArrayRef<PatternCodeRegion*> RegionVec){
 	for(PatternCodeRegion* CodeReg : RegionVec){
 		HPCParallelPattern* Pattern = CodeReg->GetPatternOccurrence()->GetPattern();
 		std::cout << "\033[36m" << Pattern->GetDesignSpaceStr() << ":\33[33m " << Pattern->GetPatternName() << "\33[0m";
@@ -321,115 +287,3 @@ void PatternCodeRegion::PrintVecOfPattern(std::vector<PatternCodeRegion*> Region
 
 	}
 }
-
-/*
- * Pattern Stack Management
- */
-std::vector<PatternCodeRegion*> PatternContext;
-std::vector<PatternCodeRegion*> OnlyPatternContext;
-
-/**
- * @brief Add a PatternCodeRegion to the top of the pattern context stack.
- *
- * @param PatternReg Code Region to be placed on the stack.
- **/
-void AddToPatternStack(PatternCodeRegion* PatternReg)
-{
-	PatternContext.push_back(PatternReg);
-}
-
-void AddToOnlyPatternStack(PatternCodeRegion* PatternReg)
-{
-
-	OnlyPatternContext.push_back(PatternReg);
-}
-
-/**
- * @brief Get the top of the pattern context stack.
- *
- * @return Top PatternCodeRegion or NULL if stack is empty.
- **/
-PatternCodeRegion* GetTopPatternStack()
-{
-	if (!PatternContext.empty())
-	{
-		return PatternContext.back();
-	}
-		return NULL;
-}
-
-PatternCodeRegion* GetTopOnlyPatternStack(){
-	if (!OnlyPatternContext.empty())
-	{
-		return OnlyPatternContext.back();
-	}
-		return NULL;
-}
-
-/**
- * @brief Remove top of the pattern context from the stack if the ID matches with the function input. Prints an error message if not.
- *
- * @param ID The suspected ID of the pattern context top.
- **/
-void RemoveFromPatternStack(std::string ID)
-{
-	if (!PatternContext.empty())
-	{
-		try{
-			int i = 0;
-			for(PatternCodeRegion* PatCodeReg : PatternContext){
-			if (!ID.compare(PatCodeReg->GetID()))
-			{
-				PatternContext.erase(PatternContext.begin()+i);
-				return;
-			}
-			i++;
-		}
-		throw TooManyEndsException(ID);
-		}
-		catch(TooManyEndsException& endsExeption){
-
-			endsExeption.what();
-			throw TerminateEarlyException();
-		}
-	}
-}
-
-void RemoveFromOnlyPatternStack(std::string ID){
-	if(!OnlyPatternContext.empty())
-	{
-		// we need to compare if the ID is the same as the ID of the Pattern that we inserted first in the stack
-		/*usually the WrongNestingException is encountered before this function*/
-		try{
-			int i = 0;
-			for(PatternCodeRegion* PatCodeReg : OnlyPatternContext){
-				if (!ID.compare(PatCodeReg->GetID()))
-				{
-					OnlyPatternContext.erase(OnlyPatternContext.begin()+i);
-					return;
-				}
-				i++;
-			}
-			throw WrongNestingException(ID, ID);
-		}
-		catch(WrongNestingException& wrongNest){
-			std::cout << wrongNest.what() << std::endl;
-			throw TerminateEarlyException();
-		}
-	}
-	else{
-			//std::cout << "You probably added one end of a patten to much.\n" << ID << " ends outside of any Pattern." << std::endl;
-	}
-}
-
-PatternCodeRegion* PatternIDisUsed(std::string ID){
-	std::vector<PatternCodeRegion*> PatternCodeRegions = PatternGraph::GetInstance()->GetAllPatternCodeRegions();
-	for(PatternCodeRegion* PatCodeReg : PatternCodeRegions){
-		if(!(ID.compare(PatCodeReg->GetID()))){
-			return PatCodeReg;
-		}
-	}
-	return NULL;
-}
-/*Stack for Halstead */
-std::vector<PatternOccurrence*> OccStackForHalstead;
@@ -6,8 +6,12 @@
 #include <queue>
 #include "clang/AST/Decl.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/iterator.h"
 
 #include "DesignSpaces.h"
+#include "AtomTable.h"
+#include "SourcePosition.h"
 #include "PatternGraph.h"
 
 
@@ -26,7 +30,7 @@ class PatternCodeRegion;
 class HPCParallelPattern
 {
 public:
-	HPCParallelPattern(DesignSpace DesignSp, std::string PatternName);
+	HPCParallelPattern(DesignSpace DesignSp, Atom PatternName);
 
 	void Print();
 
@@ -34,11 +38,13 @@ public:
 
 	void AddOccurrence(PatternOccurrence* Occurrence);
 
-	std::vector<PatternOccurrence*> GetOccurrences();
+	llvm::ArrayRef<PatternOccurrence*> GetOccurrences() { return this->Occurrences; }
 
-	std::vector<PatternCodeRegion*> GetCodeRegions();
+	CodeRegionRange GetCodeRegions();
 
-	std::string GetPatternName() { return this->PatternName; }
+	std::string GetPatternName() { return AtomTable::GetString(this->PatternName).str(); }
+
+	Atom GetPatternNameAtom() { return this->PatternName; }
 
 	std::string GetDesignSpaceStr() { return DesignSpaceToStr(this->DesignSp); }
 
@@ -50,11 +56,15 @@ public:
 
 	void incrementNumOfOperators();
 
+	void AddNumOfOperators(int Num);
+
 	int GetNumOfOperators();
 
 private:
+	friend class GraphSnapshot;
+
 	DesignSpace DesignSp;
-	std::string PatternName;
+	Atom PatternName;
 
 	int numOfOperators = 0;
 
@@ -72,17 +82,19 @@ private:
 class PatternOccurrence
 {
 public:
-	PatternOccurrence(HPCParallelPattern* Pattern, std::string ID);
+	PatternOccurrence(HPCParallelPattern* Pattern, Atom ID);
 
 	HPCParallelPattern* GetPattern() { return this->Pattern; }
 
 	void Print();
 
-	std::string GetID() { return this->ID; }
+	std::string GetID() { return AtomTable::GetString(this->ID).str(); }
+
+	Atom GetIDAtom() { return this->ID; }
 
 	void AddCodeRegion(PatternCodeRegion* CodeRegion) { this->CodeRegions.push_back(CodeRegion); }
 
-	std::vector<PatternCodeRegion*> GetCodeRegions() { return this->CodeRegions; }
+	llvm::ArrayRef<PatternCodeRegion*> GetCodeRegions() { return this->CodeRegions; }
 
 	int GetTotalLinesOfCode();
 
@@ -95,7 +107,75 @@ private:
 
 	std::vector<PatternCodeRegion*> CodeRegions;
 
-	std::string ID;
+	Atom ID;
+};
+
+/**
+ * A read-only range over the code regions of a list of PatternOccurrences.
+ * The code regions are visited occurrence by occurrence without copying them into a new vector.
+ * The range is invalidated if an occurrence or a code region is added.
+ */
+class CodeRegionRange
+{
+public:
+	class iterator : public llvm::iterator_facade_base<iterator, std::forward_iterator_tag, PatternCodeRegion*, std::ptrdiff_t, PatternCodeRegion**, PatternCodeRegion*>
+	{
+	public:
+		iterator(llvm::ArrayRef<PatternOccurrence*> Occurrences, size_t Occ) : Occurrences(Occurrences), Occ(Occ), Reg(0)
+		{
+			SkipEmptyOccurrences();
+		}
+
+		PatternCodeRegion* operator*() const { return Occurrences[Occ]->GetCodeRegions()[Reg]; }
+
+		iterator& operator++()
+		{
+			Reg++;
+			SkipEmptyOccurrences();
+			return *this;
+		}
+
+		bool operator==(const iterator& Other) const { return Occ == Other.Occ && Reg == Other.Reg; }
+
+	private:
+		void SkipEmptyOccurrences()
+		{
+			while (Occ < Occurrences.size() && Reg >= Occurrences[Occ]->GetCodeRegions().size())
+			{
+				Occ++;
+				Reg = 0;
+			}
+		}
+
+		llvm::ArrayRef<PatternOccurrence*> Occurrences;
+		size_t Occ;
+		size_t Reg;
+	};
+
+	CodeRegionRange(llvm::ArrayRef<PatternOccurrence*> Occurrences) : Occurrences(Occurrences)
+	{
+	}
+
+	iterator begin() const { return iterator(Occurrences, 0); }
+
+	iterator end() const { return iterator(Occurrences, Occurrences.size()); }
+
+	bool empty() const { return begin() == end(); }
+
+	size_t size() const
+	{
+		size_t Size = 0;
+
+		for (PatternOccurrence* PatternOcc : Occurrences)
+		{
+			Size += PatternOcc->GetCodeRegions().size();
+		}
+
+		return Size;
+	}
+
+private:
+	llvm::ArrayRef<PatternOccurrence*> Occurrences;
 };
 
 /**
@@ -106,7 +186,6 @@ private:
 class PatternCodeRegion : public PatternGraphNode
 {
 public:
-	~PatternCodeRegion();
 	PatternCodeRegion(PatternOccurrence* PatternOcc);
 
 	PatternOccurrence* GetPatternOccurrence() { return this->PatternOcc; }
@@ -126,38 +205,49 @@ public:
 
 	void AddOnlyPatternParent(PatternGraphNode* PatParent);
 
-	std::vector<PatternGraphNode*> GetChildren() { return this->Children; }
+	llvm::ArrayRef<PatternGraphNode*> GetChildren() { return this->Children; }
 
-	std::vector<PatternCodeRegion*> GetOnlyPatternChildren() { return this->PatternChildren; }
+	llvm::ArrayRef<PatternCodeRegion*> GetOnlyPatternChildren() { return this->PatternChildren; }
 
-	std::vector<PatternGraphNode*> GetParents() { return this->Parents; }
+	llvm::ArrayRef<PatternGraphNode*> GetParents() { return this->Parents; }
 
-	std::vector<PatternCodeRegion*> GetOnlyPatternParents() { return this->PatternParents; }
+	llvm::ArrayRef<PatternCodeRegion*> GetOnlyPatternParents() { return this->PatternParents; }
 
 	void SetFirstLine (int FirstLine);
 
 	void SetLastLine (int LastLine);
 
 
-	void SetStartSourceLoc(clang::SourceLocation StartLoc);
+	/**
+	 * @brief Sets the position of the Pattern_Begin call of the region.
+	 **/
+	void SetStartPosition(SourcePosition StartPos) { this->StartPos = StartPos; }
 
-	void SetEndSourceLoc(clang::SourceLocation EndLoc);
+	/**
+	 * @brief Sets the position of the Pattern_End call which closes the region.
+	 **/
+	void SetEndPosition(SourcePosition EndPos) { this->EndPos = EndPos; }
 
-	clang::SourceLocation GetStartLoc();
+	SourcePosition GetStartPosition() { return this->StartPos; }
 
-	clang::SourceLocation GetEndLoc();
+	/**
+	 * @brief Returns the position of the Pattern_End call or an invalid position if the region has not been closed.
+	 **/
+	SourcePosition GetEndPosition() { return this->EndPos; }
 
 	int GetLinesOfCode() { return this->LinesOfCode; }
 
 	std::string GetID() { return this->PatternOcc->GetID(); }
 
+	Atom GetIDAtom() { return this->PatternOcc->GetIDAtom(); }
+
 	bool HasNoPatternParents();
 
 	bool HasNoPatternChildren();
 
 	bool isInMain = false;
 
-	void PrintVecOfPattern(std::vector<PatternCodeRegion*> RegionVec);
+	void PrintVecOfPattern(llvm::ArrayRef<PatternCodeRegion*> RegionVec);
 
 	void insertCorrespondingCallTreeNode(CallTreeNode* Node){
 		CorrespondingCallTreeNodes.push_back(Node);
@@ -167,12 +257,12 @@ public:
 
 	bool isSuitedForNestingStatistics = true;
 private:
-	PatternOccurrence* PatternOcc;
+	friend class GraphSnapshot;
 
-	clang::SourceLocation SurLoc;
+	PatternOccurrence* PatternOcc;
 
-	clang::SourceLocation StartSLocation;
-	clang::SourceLocation EndSLocation;
+	SourcePosition StartPos;
+	SourcePosition EndPos;
 
 
 	std::vector<PatternGraphNode*> Parents;
@@ -185,30 +275,3 @@ private:
 	std::vector<CallTreeNode*> CorrespondingCallTreeNodes;
 
 };
-
-
-
-/**
- * The pattern stack is used to keep track of the nesting of patterns and functions.
- */
-extern std::vector<PatternCodeRegion*> PatternContext;
-/**
-	*The OnlyPatternContext only keeps track of the nesting of patterns.
-	*/
-extern std::vector<PatternCodeRegion*> OnlyPatternContext;
-
-extern std::vector<PatternOccurrence*> OccStackForHalstead;
-
-void AddToPatternStack(PatternCodeRegion* PatternOcc);
-
-void AddToOnlyPatternStack(PatternCodeRegion* PatternCodeReg);
-
-PatternCodeRegion* GetTopPatternStack();
-
-PatternCodeRegion* GetTopOnlyPatternStack();
-
-void RemoveFromPatternStack(std::string ID);
-
-void RemoveFromOnlyPatternStack(std::string ID);
-
-PatternCodeRegion* PatternIDisUsed(std::string ID);
@@ -1,6 +1,7 @@
 #include "HPCPatternInstrASTTraversal.h"
 #include "Debug.h"
 #include "HPCParallelPattern.h"
+#include "SharedPreamble.h"
 #include <string>
 
 #include <exception>
@@ -12,15 +13,18 @@
 #include "clang/Basic/SourceLocation.h"
 #include <string>
 #include "llvm/ADT/SmallVector.h"
-#include "HPCRunningStats.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <limits>
 
 #ifndef HPCERROR_H
 #include "HPCError.h"
 #endif
 
 /**
- * @brief If a function declaration is encountered, look up the corresponding database entry.
- * We set helper variables in the PatternBeginHandler and PatternEndHandler to the FunctionNode for correct parent-child-relations.
+ * @brief If a function declaration is encountered, the name and hash value of the function are recorded.
+ * When the log is replayed, the corresponding FunctionNode is looked up and set as the current function for correct parent-child-relations.
  *
  * @param Decl The clang object encountered by the visitor.
  *
@@ -33,44 +37,27 @@ bool HPCPatternInstrVisitor::VisitFunctionDecl(clang::FunctionDecl *Decl)
 	clang::SourceManager& SourceMan = Context->getSourceManager();
 	if(SourceMan.isInMainFile(Decl->getBeginLoc()))
 	{
-		CurrentFn = Decl;
-		clang::SourceLocation beginLoc = Decl->getBeginLoc();
-		clang::SourceManager& SourceMan = Context->getSourceManager();
-		clang::FullSourceLoc SourceLoc(beginLoc, SourceMan);
-		CallTreeNode* Node;
-
-		if ((CurrentFnEntry = PatternGraph::GetInstance()->GetFunctionNode(Decl)) == NULL)
-		{
-			PatternGraph::GetInstance()->RegisterFunction(Decl);
-			CurrentFnEntry = PatternGraph::GetInstance()->GetFunctionNode(Decl);
-		}
-		if(Decl->isMain()){
-			Node = ClTre->registerNode(Root, CurrentFnEntry, LastNodeType, GetTopPatternStack(), CurrentFnEntry);
-			ClTre->setRootNode(Node);
-		}
-		else
-			Node = ClTre->registerNode(Function_Decl, CurrentFnEntry, LastNodeType, GetTopPatternStack(), CurrentFnEntry);
-
-		Node->SetLineNumber(SourceLoc.getLineNumber());
-		#ifdef LOCDEBUG
-			std::cout << "setted LineNumber of: "<< *Node->GetID()<<" to "<< SourceLoc.getLineNumber()<<" verification: "<<Node->getLineNumber()<< '\n';
-		#endif
-	#ifdef PRINT_DEBUG
-		std::cout << CurrentFnEntry->GetFnName() << " (" << CurrentFnEntry->GetHash() << ")" << std::endl;
-	#endif
+		std::string FnName = Decl->getNameInfo().getName().getAsString();
+		const FunctionIdentity& Identity = GetFunctionIdentity(Decl);
+		Log->AddFunctionDecl(FnName, Identity.Hash, Identity.USR, Decl->isMain(), GetPosition(Decl->getBeginLoc()));
+	}
+	else
+	{
+		Log->AddForeignFunctionDecl();
+	}
 
-		PatternBeginHandler.SetCurrentFnEntry(CurrentFnEntry);
-		PatternEndHandler.SetCurrentFnEntry(CurrentFnEntry);
+	if(Decl->getStorageClass() != clang::StorageClass::SC_None)
+	{
+		CountOperators(Decl->getBeginLoc(), 1);
 	}
-	LastNodeType = Function_Decl;
 	return true;
 }
 
 
 /**
  * @brief When we encounter a call expression, we look up the declaration of the function called.
- * If it is one of our instrumentation functions, we extract the information from the string argument with ASTMatchers.
- * A PatternCodeRegion object is created if this is the start of a region or the current region is closed.
+ * If it is one of our instrumentation functions, we extract the string argument directly from the argument expression.
+ * When the log is replayed, a PatternCodeRegion object is created if this is the start of a region or the current region is closed.
  * For a non-instrumentation function, the function is added to the pattern which surraunds it as a child.
  * If there is no pattern, the function is a direct child of the calling function.
  *
@@ -86,6 +73,8 @@ bool HPCPatternInstrVisitor::VisitCallExpr(clang::CallExpr *CallExpr)
 	  and no used libraries*/
 	if(SourceMan.isInMainFile(CallExpr->getBeginLoc()))
 	{
+		TimeReport::Count(TRC_CallExprs);
+
 		if (!CallExpr->getBuiltinCallee() && CallExpr->getDirectCallee() && !CallExpr->getDirectCallee()->isInStdNamespace())
 		{
 			clang::FunctionDecl* Callee = CallExpr->getDirectCallee();
@@ -94,396 +83,403 @@ bool HPCPatternInstrVisitor::VisitCallExpr(clang::CallExpr *CallExpr)
 			std::cout << Callee->getNameInfo().getName().getAsString() << std::endl;
 	#endif
 
-			std::string FnName = Callee->getNameInfo().getName().getAsString();
+			InstrumentationKind Kind = GetInstrumentationKind(Callee);
 
 			// If the CallExpr is a pattern-begin expression
-			if (!FnName.compare(PATTERN_BEGIN_CXX_FNNAME) || !FnName.compare(PATTERN_BEGIN_C_FNNAME))
+			if (Kind == IK_PatternBegin)
 			{
 				/*Delivers the children of the current node*/
-				clang::Expr** Args = CallExpr->getArgs();
-	#ifdef PRINT_DEBUG
-				Args[0]->dump();
-	#endif
-				/*calls all registered callbacks on all matches on the given node.
-				  this call is pretty stong. It creates the patternCodeRegion and if there is no mathing PatternOccurrence it
-					is creating one. Also are the Child parent relations set with this call*/
-				//PatternBeginFinder is a  clang::ast_matchers::MatchFinder which uses a HPCPatternBeginInstrHandler to set everything up and the Pattern is also registered in the patternStack.
-				PatternCodeRegion* PatBeforethisPat = PatternBeginHandler.GetLastPattern();
-
-				PatternBeginFinder.match(*Args[0], *Context);
-
-				PatternCodeRegion* PatternCodeReg = PatternBeginHandler.GetLastPattern();
-
-				/* Store this PatternCodeRegion Begin in the CallTree (ClTre)*/
-
-				CallTreeNode* BeginNode = ClTre->registerNode(Pattern_Begin, PatternCodeReg, LastNodeType, PatBeforethisPat, CurrentFnEntry);
-
+				const clang::StringLiteral* Argument = GetPatternArgument(CallExpr);
 
 				/* Get the location of the fn call which denotes the beginning of this pattern */
-
 				clang::SourceLocation LocStart = CallExpr->getBeginLoc();
 
-				clang::FullSourceLoc SourceLoc(LocStart, SourceMan);
-				BeginNode->SetLineNumber(SourceLoc.getLineNumber());
-				#ifdef LOCDEBUG
-					std::cout << "setted LineNumber of: "<< *BeginNode->GetID()<<" to "<< SourceLoc.getLineNumber()<<" verification: "<<BeginNode->getLineNumber()<< '\n';
-				#endif
-				PatternCodeReg->SetFirstLine(SourceLoc.getLineNumber());
-				PatternCodeReg->SetStartSourceLoc(LocStart);
-
+				Log->AddPatternBegin(Argument != NULL, Argument != NULL ? Argument->getString().str() : "", GetPosition(LocStart));
 
-				PatternCodeReg->isInMain = SourceMan.isInMainFile(LocStart);
+				/* A region without argument is never opened by the handler, so it does not contain any operators */
+				RegionBounds Bounds;
+				Bounds.Closed = Argument == NULL || !GetMainFileOffset(LocStart, Bounds.Begin);
+				PatternDescriptor Descriptor;
+				size_t ErrorOffset;
+				const char* Error;
 
-				LastNodeType = Pattern_Begin;
+				/* A malformed argument is reported when the log is replayed */
+				if (!Bounds.Closed && ParsePatternDescriptor(Argument->getString(), Descriptor, ErrorOffset, Error))
+				{
+					Bounds.PatternID = Descriptor.PatternID;
+				}
+				Bounds.End = Bounds.Begin;
+				Regions.push_back(Bounds);
 			}
-			else if (!FnName.compare(PATTERN_END_CXX_FNNAME) || !FnName.compare(PATTERN_END_C_FNNAME))
+			else if (Kind == IK_PatternEnd)
 			{
-				clang::Expr** Args = CallExpr->getArgs();
-				#ifdef PRINT_DEBUG
-							std::cout << "Degub dump of Args before matching" << '\n';
-							Args[0]->dump();
-				#endif
-				PatternCodeRegion* PatternCodeReg;
-				try{
-					PatternEndFinder.match(*Args[0], *Context);
-					PatternCodeReg = PatternEndHandler.GetLastPattern();
-				}
-				catch(TooManyEndsException& e){
-					e.what();
-					throw TerminateEarlyException();
-				}
-				#ifdef PRINT_DEBUG
-				std::cout << "Degub dump of Args after matching" << '\n';
-							Args[0]->dump();
-				#endif
+				const clang::StringLiteral* Argument = GetPatternArgument(CallExpr);
 
 				/* Get the location of the fn call which denotes the end of this pattern */
-				clang::SourceManager& SourceMan = Context->getSourceManager();
 				clang::SourceLocation LocEnd = CallExpr->getEndLoc();
-				clang::FullSourceLoc SourceLoc(LocEnd, SourceMan);
-
-				CallTreeNode* EndNode = ClTre->registerEndNode(Pattern_End, PatternEndHandler.GetLastPatternID(), LastNodeType, PatternCodeReg, CurrentFnEntry);
-				EndNode->SetLineNumber(SourceLoc.getLineNumber());
-				#ifdef LOCDEBUG
-					std::cout << "setted LineNumber of: "<< *EndNode->GetID()<<" to "<< SourceLoc.getLineNumber()<<" verification: "<<EndNode->getLineNumber()<< '\n';
-				#endif
-			}
-			// If no: search the called function for patterns
-			else
-			{
-				/* Look up the database entry for the function in which the current callExpr is within*/
-				FunctionNode* Func;
-
-				/*if the function is not registered register*/
-				if ((Func = PatternGraph::GetInstance()->GetFunctionNode(Callee)) == NULL)
-				{
-					PatternGraph::GetInstance()->RegisterFunction(Callee);
-				}
-				Func = PatternGraph::GetInstance()->GetFunctionNode(Callee);
 
-	#ifdef PRINT_DEBUG
-				std::cout << Func->GetFnName() << " (" << Func->GetHash() << ")" << std::endl;
-	#endif
+				Log->AddPatternEnd(Argument != NULL, Argument != NULL ? Argument->getString().str() : "", GetPosition(LocEnd));
 
-				/* Store this function call in the CallTree (ClTre)*/
-				CallTreeNode* FuncNode = ClTre->registerNode(Function, Func, LastNodeType, GetTopPatternStack(), CurrentFnEntry);
-
-				clang::SourceManager& SourceMan = Context->getSourceManager();
-				clang::SourceLocation LocStart = CallExpr->getBeginLoc();
-				clang::FullSourceLoc SourceLoc(LocStart, SourceMan);
-				FuncNode->SetLineNumber(SourceLoc.getLineNumber());
-
-				PatternCodeRegion* Top;
-				/* if we are within a Pattern -> register this Functon as a child of the pattern etc. */
-				if ((Top = GetTopPatternStack()) != NULL)
+				/* Close the first (outermost) open region with this ID, like AnalysisSession::RemoveFromPatternStack() does */
+				unsigned EndOffset;
+				if (Argument != NULL && GetMainFileOffset(LocEnd, EndOffset))
 				{
-					Top->AddChild(Func);
-					Func->AddParent(Top);
-
-					Func->AddPatternParent(Top);
-					#ifdef DEBUG_J
-					std::cout << Func->GetFnName()<< " hat als PatternParent: " << Top->GetID()<< '\n';
-					#endif
-				}
-				else
-				{/*if not register this function as a child for the function in which we currenty are
-					 (because we are always inside a function this is possible)
-					 */
-					CurrentFnEntry->AddChild(Func);
-					Func->AddParent(CurrentFnEntry);
-
-					/*if the parent of this function has a PatternParent, the function inherits it to its child (Func) */
-					if(!CurrentFnEntry->HasNoPatternParents()){
-						//function has PatternParents too
-						Func->AddPatternParents(CurrentFnEntry->GetPatternParents());
-						/*If the function has PatternParents AND PatternChildre, we register the the GetPatternChildren
-							as Children of the PatternParents vice versa*/
-						if(!Func->HasNoPatternChildren()){
-							Func->registerPatChildrenToPatParents();
+					for (auto Region = Regions.begin(); Region != Regions.end(); Region++)
+					{
+						if (!Region->Closed && Region->PatternID == Argument->getString())
+						{
+							Region->End = EndOffset;
+							Region->Closed = true;
+							break;
 						}
 					}
 				}
 			}
+			// If no: search the called function for patterns
+			else
+			{
+				std::string FnName = Callee->getNameInfo().getName().getAsString();
+
+				const FunctionIdentity& Identity = GetFunctionIdentity(Callee);
+				Log->AddFunctionCall(FnName, Identity.Hash, Identity.USR, Callee->isMain(), GetPosition(CallExpr->getBeginLoc()));
+			}
 		}
 	}
 
+	/* Every call is an operator, the instrumentation calls belong to their own regions */
+	CountOperators(CallExpr->getBeginLoc(), 1);
+
 	return true;
 }
 
-HPCPatternInstrVisitor::HPCPatternInstrVisitor (clang::ASTContext* Context) : Context(Context)
+HPCPatternInstrVisitor::InstrumentationKind HPCPatternInstrVisitor::GetInstrumentationKind(clang::FunctionDecl *Callee)
 {
-	using namespace clang::ast_matchers;
-	StatementMatcher StringArgumentMatcher = hasDescendant(stringLiteral().bind("patternstr"));
+	const clang::FunctionDecl* Canonical = Callee->getCanonicalDecl();
+	auto Entry = InstrumentationKinds.find(Canonical);
 
-	PatternBeginFinder.addMatcher(StringArgumentMatcher, &PatternBeginHandler);
-	PatternEndFinder.addMatcher(StringArgumentMatcher, &PatternEndHandler);
-}
+	if (Entry != InstrumentationKinds.end())
+	{
+		return Entry->second;
+	}
 
-Halstead* currentHlst;
+	/* Identifiers are unique within the ASTContext, so the names are compared by pointer */
+	const clang::IdentifierInfo* Name = Callee->getIdentifier();
+	InstrumentationKind Kind = IK_None;
 
-HalsteadVisitor::HalsteadVisitor(clang::ASTContext *Context) : Context(Context)
-{
-	actHalstead = getActualHalstead();
+	if (Name != NULL && (Name == PatternBeginCXXName || Name == PatternBeginCName))
+	{
+		Kind = IK_PatternBegin;
+	}
+	else if (Name != NULL && (Name == PatternEndCXXName || Name == PatternEndCName))
+	{
+		Kind = IK_PatternEnd;
+	}
+
+	InstrumentationKinds[Canonical] = Kind;
+	return Kind;
 }
 
- /* Consumer function implementations
- */
-void HPCPatternInstrConsumer::HandleTranslationUnit(clang::ASTContext &Context)
+const clang::StringLiteral* HPCPatternInstrVisitor::GetPatternArgument(clang::CallExpr *CallExpr)
 {
-	/* Traverse the AST for comments and parse them */
-	DEBUG_MESSAGE("Using Visitor to traverse from top translation declaration unit");
-	Visitor.TraverseDecl(Context.getTranslationUnitDecl());
-}
+	if (CallExpr->getNumArgs() == 0)
+	{
+		return NULL;
+	}
 
-bool HalsteadVisitor::VisitBinaryOperator(clang::BinaryOperator *BinarOp){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(BinarOp, &isInPatterns);
+	/* Usually the argument is the literal itself, otherwise it is wrapped, e.g. in the construction of a std::string */
+	llvm::SmallVector<const clang::Stmt*, 8> Worklist;
+	Worklist.push_back(CallExpr->getArg(0));
 
-	if(isInPatterns.empty()){
-			return true;
-	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
+	while (!Worklist.empty())
+	{
+		const clang::Stmt* Stmt = Worklist.pop_back_val();
+
+		if (Stmt == NULL)
+		{
+			continue;
 		}
+
+		if (const clang::StringLiteral* Literal = clang::dyn_cast<clang::StringLiteral>(Stmt))
+		{
+			return Literal;
+		}
+
+		/* Push the children in reverse order, so the first literal in source order is found first */
+		llvm::SmallVector<const clang::Stmt*, 4> Children(Stmt->child_begin(), Stmt->child_end());
+		Worklist.append(Children.rbegin(), Children.rend());
 	}
-	return true;
+
+	return NULL;
 }
 
-bool HalsteadVisitor::VisitDeclStmt(clang::DeclStmt *DclStmt){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(DclStmt, &isInPatterns);
+const HPCPatternInstrVisitor::FunctionIdentity& HPCPatternInstrVisitor::GetFunctionIdentity(clang::FunctionDecl *Decl)
+{
+	clang::FunctionDecl* Canonical = Decl->getCanonicalDecl();
+	auto Entry = FunctionIdentities.find(Canonical);
 
-	if(isInPatterns.empty()){
-			return true;
-	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
-		}
+	if (Entry != FunctionIdentities.end())
+	{
+		return Entry->second;
 	}
-	return true;
+
+	std::string USR = PatternGraph::GetFunctionUSR(Canonical);
+	FunctionIdentity& Identity = FunctionIdentities[Canonical];
+	Identity.Hash = PatternGraph::CalculateFunctionHash(USR);
+	Identity.USR = AtomTable::Intern(USR);
+	return Identity;
 }
 
-bool HalsteadVisitor::VisitCallExpr(clang::CallExpr *CallExpr){
-
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(CallExpr, &isInPatterns);
-	clang::Decl* CalleeDecl = CallExpr->getCalleeDecl();
-	clang::SourceManager& SurMan = Context->getSourceManager();
-	if(SurMan.isInMainFile(CallExpr->getExprLoc())){
-		/*	CalleeDecl->dump();
-			std::cout << "STATEMENT DUMP: " << '\n';
-			clang::Stmt* CalleeStmt = CalleeDecl->getBody();
-			CalleeStmt->dump();*/
+bool HPCPatternInstrVisitor::TraverseDecl(clang::Decl *Decl)
+{
+	if (CallsOnly && Decl != NULL && !clang::isa<clang::TranslationUnitDecl>(Decl) && !Context->getSourceManager().isInMainFile(Decl->getLocation()))
+	{
+		return true;
 	}
 
+	return clang::RecursiveASTVisitor<HPCPatternInstrVisitor>::TraverseDecl(Decl);
+}
 
-	if(isInPatterns.empty()){
-			return true;
-	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
-		}
-	}
-	return true;
+HPCPatternInstrVisitor::HPCPatternInstrVisitor (clang::ASTContext* Context, TranslationUnitLog* Log, bool CallsOnly) : Context(Context), Log(Log), CallsOnly(CallsOnly)
+{
+	/* The names of the instrumentation functions are looked up once per translation unit */
+	PatternBeginCXXName = &Context->Idents.get(PATTERN_BEGIN_CXX_FNNAME);
+	PatternBeginCName = &Context->Idents.get(PATTERN_BEGIN_C_FNNAME);
+	PatternEndCXXName = &Context->Idents.get(PATTERN_END_CXX_FNNAME);
+	PatternEndCName = &Context->Idents.get(PATTERN_END_C_FNNAME);
 }
 
-bool HalsteadVisitor::VisitUnaryOperator(clang::UnaryOperator *UnaryOp){
+ /* Consumer function implementations
+ */
+static bool PrefilterEnabled = false;
+static bool SkipHeaderBodiesEnabled = true;
+static bool ParseReportEnabled = false;
 
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(UnaryOp, &isInPatterns);
+/* The parse time of the last translation unit analysed on this thread, for the ParseBaselineAction */
+static thread_local double LastParseTime = 0;
 
-	if(isInPatterns.empty()){
-			return true;
-	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
-		}
+bool HPCPatternInstrConsumer::shouldSkipFunctionBody(clang::Decl *Decl)
+{
+	if (Context->getSourceManager().isInMainFile(Decl->getLocation()))
+	{
+		return false;
 	}
+
+	NumSkippedBodies++;
 	return true;
 }
 
-bool HalsteadVisitor::VisitCompoundAssignOperator(clang::CompoundAssignOperator *CompAsOp){
-
-		std::vector<HPCParallelPattern*> isInPatterns;
-		IsStmtInAPatt(CompAsOp, &isInPatterns);
+void HPCPatternInstrConsumer::HandleTranslationUnit(clang::ASTContext &Context)
+{
+	/* The whole translation unit has been parsed when this is called */
+	Times.ParsingDone();
 
-		if(isInPatterns.empty()){
-				return true;
-		}
-		else{
-			for(HPCParallelPattern* Pat : isInPatterns){
-				Pat->incrementNumOfOperators();
-			}
-		}
-		return true;
-}
+	if (ParseReportEnabled)
+	{
+		std::chrono::duration<double, std::milli> ParseTime = std::chrono::steady_clock::now() - ParseStart;
+		LastParseTime = ParseTime.count();
 
-bool HalsteadVisitor::VisitMemberExpr(clang::MemberExpr *MemExpr){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(MemExpr, &isInPatterns);
+		std::string Report;
+		llvm::raw_string_ostream ReportStream(Report);
+		ReportStream << Log.GetSourceFile() << ": parsed in " << llvm::format("%.1f", ParseTime.count()) << " ms, " << NumSkippedBodies << " function bodies outside of the main file skipped\n";
 
-	if(isInPatterns.empty()){
-			return true;
+		/* One write per translation unit, so the lines of the workers are not mixed up */
+		llvm::errs() << ReportStream.str();
 	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
-		}
-	}
-	return true;
-}
 
-bool HalsteadVisitor::VisitStringLiteral(clang::StringLiteral *StrgLit){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(StrgLit, &isInPatterns);
+	/* Traverse the AST for comments and parse them */
+	DEBUG_MESSAGE("Using Visitor to traverse from top translation declaration unit");
+	Visitor.TraverseDecl(Context.getTranslationUnitDecl());
+	Visitor.RecordHalsteadOperators();
+	Times.Done();
 
-	if(isInPatterns.empty()){
-			return true;
-	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
+	if (std::vector<TranslationUnitLog>* Sink = TranslationUnitLog::GetThreadSink())
+	{
+		/* Remember all files the translation unit consists of, so a cached log can be validated later */
+		clang::SourceManager& SourceMan = Context.getSourceManager();
+		for (auto File = SourceMan.fileinfo_begin(); File != SourceMan.fileinfo_end(); File++)
+		{
+			llvm::SmallString<256> Path(File->first->getName());
+			SourceMan.getFileManager().makeAbsolutePath(Path);
+			Log.AddDependency(Path.str().str());
 		}
+
+		Sink->push_back(std::move(Log));
+	}
+	else
+	{
+		Log.Replay(Session);
 	}
-	return true;
 }
 
-bool HalsteadVisitor::VisitCharacterLiteral(clang::CharacterLiteral *CharLit){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsStmtInAPatt(CharLit, &isInPatterns);
+bool HPCPatternInstrVisitor::GetMainFileOffset(clang::SourceLocation Loc, unsigned& Offset)
+{
+	clang::SourceManager& SourceMan = Context->getSourceManager();
 
-	if(isInPatterns.empty()){
-			return true;
+	if (Loc.isInvalid())
+	{
+		return false;
 	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			Pat->incrementNumOfOperators();
-		}
+
+	std::pair<clang::FileID, unsigned> Decomposed = SourceMan.getDecomposedExpansionLoc(Loc);
+
+	if (Decomposed.first != SourceMan.getMainFileID())
+	{
+		return false;
 	}
+
+	Offset = Decomposed.second;
 	return true;
 }
 
-/*bisher werden nur die TypeQualifiers gezählt. will man noch einmal die Decl selbst mit zählen muss man plus 1 rechnen*/
-bool HalsteadVisitor::VisitVarDecl(clang::VarDecl *VrDcl){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsDeclInAPatt(VrDcl, &isInPatterns);
+SourcePosition HPCPatternInstrVisitor::GetPosition(clang::SourceLocation Loc)
+{
+	SourcePosition Pos;
 
-	if(isInPatterns.empty()){
-			return true;
+	if (Loc.isInvalid())
+	{
+		return Pos;
 	}
-	else{
-		int numTypeQual = HalsteadVisitor::countQual(VrDcl);
-		/*
-		countQual return the number of TypeQualifiers excluding the default qualifier */
-		for(HPCParallelPattern* Pat : isInPatterns){
-			for (size_t i = 0; i < numTypeQual; i++) {
-					Pat->incrementNumOfOperators();
-			}
-			/*is the variable mot only declared but also initialized, than we have one operator more
-			  in the patterns  */
 
-			if(VrDcl->hasInit()){
-				Pat->incrementNumOfOperators();
-			}
-			/*count the storage class specifiers*/
-			if(VrDcl->getStorageClass()!= clang::StorageClass::SC_None){
-				Pat->incrementNumOfOperators();
-			}
+	clang::SourceManager& SourceMan = Context->getSourceManager();
+	std::pair<clang::FileID, unsigned> Decomposed = SourceMan.getDecomposedExpansionLoc(Loc);
+
+	/* Almost all positions are in the main file, so the file is only interned again if it changes */
+	if (Decomposed.first != PositionFileID)
+	{
+		PositionFileID = Decomposed.first;
+		PositionFile = 0;
+
+		if (const clang::FileEntry* Entry = SourceMan.getFileEntryForID(Decomposed.first))
+		{
+			PositionFile = AtomTable::Intern(Entry->getName());
 		}
 	}
-	return true;
+
+	Pos.File = PositionFile;
+	Pos.Line = SourceMan.getLineNumber(Decomposed.first, Decomposed.second);
+	Pos.Column = SourceMan.getColumnNumber(Decomposed.first, Decomposed.second);
+	Pos.Offset = Decomposed.second;
+	return Pos;
 }
 
-bool HalsteadVisitor::VisitFunctionDecl(clang::FunctionDecl *FctDecl){
-	std::vector<HPCParallelPattern*> isInPatterns;
-	IsDeclInAPatt(FctDecl, &isInPatterns);
+void HPCPatternInstrVisitor::CountOperators(clang::SourceLocation Loc, int Num)
+{
+	unsigned Offset;
 
-	if(isInPatterns.empty()){
-			return true;
-	}
-	else{
-		for(HPCParallelPattern* Pat : isInPatterns){
-			if(FctDecl->getStorageClass() != clang::StorageClass::SC_None ) Pat->incrementNumOfOperators();
-		}
+	/* Without a pattern code region the operators are not needed */
+	if (!CallsOnly && Num > 0 && GetMainFileOffset(Loc, Offset))
+	{
+		Operators.push_back(std::make_pair(Offset, Num));
 	}
-	return true;
 }
 
+void HPCPatternInstrVisitor::RecordHalsteadOperators()
+{
+	CodeRegionIndex Index;
 
-void HalsteadVisitor::IsStmtInAPatt(clang::Stmt *Stm, std::vector<HPCParallelPattern*> *isInPatterns){
+	for (unsigned Ordinal = 0; Ordinal < Regions.size(); Ordinal++)
+	{
+		RegionBounds& Bounds = Regions[Ordinal];
 
-	std::vector<PatternOccurrence*> WorkOccStackForHalstead(OccStackForHalstead.begin(), OccStackForHalstead.end()) ;
-	// WorkOccStackForHalstead is correctly initialized
-	clang::SourceManager& SourceMan = Context->getSourceManager();
+		if (Bounds.PatternID.empty())
+		{
+			continue;
+		}
 
-	for (int i = 0; i < WorkOccStackForHalstead.size(); i++){
+		/* A region which is not closed in this translation unit extends to the end of the file */
+		Index.AddRegion(Bounds.Begin, Bounds.Closed ? Bounds.End : std::numeric_limits<unsigned>::max(), Ordinal);
+	}
 
-		PatternOccurrence* PatOcc = WorkOccStackForHalstead[i];
-		std::vector<PatternCodeRegion*> CodeRegions = PatOcc->GetCodeRegions();
-		getActualHalstead()->insertPattern(PatOcc->GetPattern());
+	if (!Index.empty() && !Operators.empty())
+	{
+		Index.Build();
 
-		for(int i = 0; i < CodeRegions.size(); i++){
+		std::vector<int> NumOperators(Regions.size(), 0);
+		llvm::SmallVector<unsigned, 8> Containing;
 
-			PatternCodeRegion* CodeReg = CodeRegions[i];
-			bool ExprAfterBegStmt = SourceMan.isPointWithin (Stm->getEndLoc(),CodeReg->GetStartLoc(), CodeReg->GetEndLoc());
-			if(ExprAfterBegStmt){
+		for (std::pair<unsigned, int>& Operator : Operators)
+		{
+			Containing.clear();
+			Index.FindContainingRegions(Operator.first, Containing);
 
-				isInPatterns->push_back(PatOcc->GetPattern());
+			for (unsigned Ordinal : Containing)
+			{
+				NumOperators[Ordinal] += Operator.second;
+			}
+		}
 
+		for (unsigned Ordinal = 0; Ordinal < Regions.size(); Ordinal++)
+		{
+			if (NumOperators[Ordinal] > 0)
+			{
+				Log->AddHalsteadOperators(Ordinal, NumOperators[Ordinal]);
 			}
 		}
 	}
+
+	Operators.clear();
+	Regions.clear();
 }
 
-	void HalsteadVisitor::IsDeclInAPatt(clang::Decl *Dcl, std::vector<HPCParallelPattern*> *isInPatterns){
+bool HPCPatternInstrVisitor::VisitBinaryOperator(clang::BinaryOperator *BinarOp){
+	CountOperators(BinarOp->getBeginLoc(), 1);
+	return true;
+}
 
-			std::vector<PatternOccurrence*> WorkOccStackForHalstead(OccStackForHalstead.begin(), OccStackForHalstead.end()) ;
+bool HPCPatternInstrVisitor::VisitDeclStmt(clang::DeclStmt *DclStmt){
+	CountOperators(DclStmt->getBeginLoc(), 1);
+	return true;
+}
 
-			clang::SourceManager& SourceMan = Context->getSourceManager();
+bool HPCPatternInstrVisitor::VisitUnaryOperator(clang::UnaryOperator *UnaryOp){
+	CountOperators(UnaryOp->getBeginLoc(), 1);
+	return true;
+}
 
-			for (int i = 0; i < WorkOccStackForHalstead.size(); i++){
+/* A CompoundAssignOperator is also visited as a BinaryOperator, so it counts twice */
+bool HPCPatternInstrVisitor::VisitCompoundAssignOperator(clang::CompoundAssignOperator *CompAsOp){
+	CountOperators(CompAsOp->getBeginLoc(), 1);
+	return true;
+}
 
-				PatternOccurrence* PatOcc = WorkOccStackForHalstead[i];
-				std::vector<PatternCodeRegion*> CodeRegions = PatOcc->GetCodeRegions();
-				getActualHalstead()->insertPattern(PatOcc->GetPattern());
+bool HPCPatternInstrVisitor::VisitMemberExpr(clang::MemberExpr *MemExpr){
+	CountOperators(MemExpr->getBeginLoc(), 1);
+	return true;
+}
 
-				for(int i = 0; i < CodeRegions.size(); i++){
+bool HPCPatternInstrVisitor::VisitStringLiteral(clang::StringLiteral *StrgLit){
+	CountOperators(StrgLit->getBeginLoc(), 1);
+	return true;
+}
 
-					PatternCodeRegion* CodeReg = CodeRegions[i];
-					bool ExprAfterBegStmt = SourceMan.isPointWithin (Dcl->getLocation(),CodeReg->GetStartLoc(), CodeReg->GetEndLoc());
+bool HPCPatternInstrVisitor::VisitCharacterLiteral(clang::CharacterLiteral *CharLit){
+	CountOperators(CharLit->getBeginLoc(), 1);
+	return true;
+}
 
-					if(ExprAfterBegStmt){
-						isInPatterns->push_back(PatOcc->GetPattern());
-					}
-				}
-			}
-		}
+/*bisher werden nur die TypeQualifiers gezählt. will man noch einmal die Decl selbst mit zählen muss man plus 1 rechnen*/
+bool HPCPatternInstrVisitor::VisitVarDecl(clang::VarDecl *VrDcl){
+	unsigned Offset;
+	if(CallsOnly || !GetMainFileOffset(VrDcl->getLocation(), Offset)){
+		return true;
+	}
+	/*
+	countQual return the number of TypeQualifiers excluding the default qualifier */
+	int Num = countQual(VrDcl);
+	/*is the variable mot only declared but also initialized, than we have one operator more
+	  in the patterns  */
+	if(VrDcl->hasInit()){
+		Num++;
+	}
+	/*count the storage class specifiers*/
+	if(VrDcl->getStorageClass()!= clang::StorageClass::SC_None){
+		Num++;
+	}
+	CountOperators(VrDcl->getLocation(), Num);
+	return true;
+}
 
-	int HalsteadVisitor::countQual(clang::VarDecl* VDecl){
+	int HPCPatternInstrVisitor::countQual(clang::VarDecl* VDecl){
 			llvm::SmallVector<clang::Attr*, 4> Attributes;
 
 			clang::QualType type = VDecl->getType();
@@ -510,13 +506,101 @@ void HalsteadVisitor::IsStmtInAPatt(clang::Stmt *Stm, std::vector<HPCParallelPat
 /*
  * Frontend action function implementations
  */
+void HPCPatternInstrAction::SetPrefilter(bool Enable)
+{
+	PrefilterEnabled = Enable;
+}
+
+void HPCPatternInstrAction::SetSkipHeaderBodies(bool Enable)
+{
+	SkipHeaderBodiesEnabled = Enable;
+}
+
+void HPCPatternInstrAction::SetParseReport(bool Enable)
+{
+	ParseReportEnabled = Enable;
+}
+
+bool HPCPatternInstrAction::NeedsParseBaseline()
+{
+	/* Without skipping the analysis itself is the baseline */
+	return ParseReportEnabled && SkipHeaderBodiesEnabled;
+}
+
+std::string HPCPatternInstrAction::GetAnalysisMode()
+{
+	return std::string("prefilter=") + (PrefilterEnabled ? "1" : "0") + " skipHeaderBodies=" + (SkipHeaderBodiesEnabled ? "1" : "0");
+}
+
+bool HPCPatternInstrAction::MayContainInstrumentationCall(llvm::StringRef Code)
+{
+	/* The names of the C functions end with the names of the C++ functions */
+	return Code.contains(PATTERN_BEGIN_CXX_FNNAME) || Code.contains(PATTERN_END_CXX_FNNAME);
+}
+
+bool HPCPatternInstrAction::BeginInvocation(clang::CompilerInstance &Compiler)
+{
+	if (!Compiler.getPreprocessorOpts().ImplicitPCHInclude.empty())
+	{
+		SharedPreamble::DetectRejection(Compiler);
+	}
+
+	return clang::ASTFrontendAction::BeginInvocation(Compiler);
+}
+
 std::unique_ptr<clang::ASTConsumer> HPCPatternInstrAction::CreateASTConsumer(clang::CompilerInstance &Compiler, llvm::StringRef InFile)
 {
 	DEBUG_MESSAGE("Creating consumer object!")
-	return std::unique_ptr<clang::ASTConsumer>(new HPCPatternInstrConsumer(&Compiler.getASTContext()));
+
+	/* The main file is already loaded by the source manager, but not parsed yet */
+	bool CallsOnly = false;
+	if (PrefilterEnabled)
+	{
+		clang::SourceManager& SourceMan = Compiler.getSourceManager();
+		CallsOnly = !MayContainInstrumentationCall(SourceMan.getBufferData(SourceMan.getMainFileID()));
+	}
+
+	/* The parser asks the consumer for every function body, see HPCPatternInstrConsumer::shouldSkipFunctionBody() */
+	Compiler.getFrontendOpts().SkipFunctionBodies = SkipHeaderBodiesEnabled;
+
+	return std::unique_ptr<clang::ASTConsumer>(new HPCPatternInstrConsumer(&Compiler.getASTContext(), InFile, Session, CallsOnly));
 }
 
-std::unique_ptr<clang::ASTConsumer> HalsteadClassAction::CreateASTConsumer(clang::CompilerInstance &Compiler, llvm::StringRef InFile)
+
+
+
+/**
+ * Measures the parse time of a translation unit for the ParseBaselineAction.
+ */
+class ParseBaselineConsumer : public clang::ASTConsumer
+{
+public:
+	explicit ParseBaselineConsumer(llvm::StringRef InFile) : File(InFile.str()), ParseStart(std::chrono::steady_clock::now())
+	{
+	}
+
+	void HandleTranslationUnit(clang::ASTContext &Context) override
+	{
+		std::chrono::duration<double, std::milli> ParseTime = std::chrono::steady_clock::now() - ParseStart;
+
+		std::string Report;
+		llvm::raw_string_ostream ReportStream(Report);
+		ReportStream << File << ": parsed in " << llvm::format("%.1f", ParseTime.count()) << " ms without skipping function bodies, ";
+		ReportStream << llvm::format("%.1f", ParseTime.count() - LastParseTime) << " ms saved by skipping\n";
+
+		llvm::errs() << ReportStream.str();
+	}
+
+private:
+	std::string File;
+	std::chrono::steady_clock::time_point ParseStart;
+};
+
+std::unique_ptr<clang::ASTConsumer> ParseBaselineAction::CreateASTConsumer(clang::CompilerInstance &Compiler, llvm::StringRef InFile)
 {
-	return std::unique_ptr<clang::ASTConsumer>(new HalsteadConsumer(&Compiler.getASTContext()));
+	/* The diagnostics were already reported by the analysis */
+	Compiler.getDiagnostics().setSuppressAllDiagnostics(true);
+	Compiler.getFrontendOpts().SkipFunctionBodies = false;
+
+	return std::unique_ptr<clang::ASTConsumer>(new ParseBaselineConsumer(InFile));
 }
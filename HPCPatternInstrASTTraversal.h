@@ -2,6 +2,9 @@
 
 #include "HPCPatternInstrHandler.h"
 #include "HPCParallelPattern.h"
+#include "TranslationUnitLog.h"
+#include "CodeRegionIndex.h"
+#include "TimeReport.h"
 
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/AST/ASTConsumer.h"
@@ -13,8 +16,10 @@
 #include "clang/AST/Comment.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/Decl.h"
-#include "clang/ASTMatchers/ASTMatchers.h"
-#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Basic/IdentifierTable.h"
+#include "llvm/ADT/DenseMap.h"
+#include <unordered_map>
+#include <chrono>
 
 
 #define PATTERN_BEGIN_C_FNNAME "PatternInstrumentation_Pattern_Begin"
@@ -29,105 +34,278 @@
  * A custom visitor, overriding functions from the RecursiveASTVisitor.
  * It searches for function declarations to build connections between function declarations and calls.
  * It also looks for call expressions in the code and links these expressions to the corresponding function declarations.
- * If a pattern instrumentation call is encountered, a PatternCodeRegion is created/closed and registered with the HPCPatternDatabase.
+ * Instrumentation calls are recognised by the declaration of the callee and their string argument is extracted.
+ * All of this is recorded in a TranslationUnitLog, which creates the PatternCodeRegions and registers them with the PatternGraph when it is replayed.
+ * In the same traversal the operators of the Halstead metric in the main file are recorded with their file offsets.
+ * After the traversal they are assigned to the pattern code regions containing them with a CodeRegionIndex.
  */
 class HPCPatternInstrVisitor : public clang::RecursiveASTVisitor<HPCPatternInstrVisitor>
 {
 public:
-	explicit HPCPatternInstrVisitor(clang::ASTContext *Context);
+	/**
+	 * @param CallsOnly True if the main file contains no instrumentation call (see HPCPatternInstrAction::SetPrefilter()).
+	 * Then only the function declarations and calls in the main file are recorded and the declarations of the headers are not traversed.
+	 **/
+	explicit HPCPatternInstrVisitor(clang::ASTContext *Context, TranslationUnitLog *Log, bool CallsOnly = false);
+
+	/**
+	 * @brief Skips declarations outside of the main file, if only function declarations and calls are recorded.
+	 * Without a pattern begin these declarations do not add anything to the log.
+	 **/
+	bool TraverseDecl(clang::Decl *Decl);
 
 	bool VisitFunctionDecl(clang::FunctionDecl *Decl);
 
 	bool VisitCallExpr(clang::CallExpr *CallExpr);
 
+	/* Operators of the Halstead metric */
+	bool VisitBinaryOperator(clang::BinaryOperator *BinarOp);
+	bool VisitUnaryOperator(clang::UnaryOperator *UnaryOp);
+	bool VisitDeclStmt(clang::DeclStmt *DclStmt);
+	bool VisitCompoundAssignOperator(clang::CompoundAssignOperator *CompAsOp);
+	bool VisitMemberExpr(clang::MemberExpr *MemExpr);
+	bool VisitStringLiteral(clang::StringLiteral *StrgLit);
+	bool VisitCharacterLiteral(clang::CharacterLiteral *CharLit);
+	bool VisitVarDecl(clang::VarDecl *VrDcl);
+
+	/**
+	 * @brief Assigns the recorded operators to the pattern code regions of the translation unit which contain them and records the sums in the log.
+	 * Has to be called after the traversal.
+	 **/
+	void RecordHalsteadOperators();
+
 private:
-	clang::ASTContext *Context;
+	/**
+	 * @brief Records Halstead operators at a location in the main file. Operators outside of the main file are not part of any pattern code region.
+	 **/
+	void CountOperators(clang::SourceLocation Loc, int Num);
 
 	/**
- 	 * This is a match finder to extract the string argument from the pattern instrumentation call and pass it to the HPCPatternBeginInstrHandler
- 	 */
-	clang::ast_matchers::MatchFinder PatternBeginFinder;
+	 * @brief Returns true and the offset of the location in the main file, if the location (or the expansion of a macro) is in the main file.
+	 **/
+	bool GetMainFileOffset(clang::SourceLocation Loc, unsigned& Offset);
 
 	/**
- 	 * See HPCPatternInstrVisitor::PatternBeginFinder
- 	 */
-	clang::ast_matchers::MatchFinder PatternEndFinder;
+	 * @brief Resolves a location (or the expansion of a macro) to a SourcePosition, which stays valid after the SourceManager has been destroyed.
+	 **/
+	SourcePosition GetPosition(clang::SourceLocation Loc);
 
-	HPCPatternBeginInstrHandler PatternBeginHandler;
-	HPCPatternEndInstrHandler PatternEndHandler;
+	static int countQual(clang::VarDecl* VDecl);
 
-	clang::FunctionDecl* CurrentFn;
-	FunctionNode* CurrentFnEntry;
+	enum InstrumentationKind
+	{
+		IK_None,
+		IK_PatternBegin,
+		IK_PatternEnd
+	};
 
-	// denotes which type of nodes we analyzed lastVisit
-	CallTreeNodeType LastNodeType;
-};
+	/**
+	 * @brief Returns if the function is one of the instrumentation functions. The result is memoized for each canonical declaration.
+	 **/
+	InstrumentationKind GetInstrumentationKind(clang::FunctionDecl *Callee);
 
+	/**
+	 * @brief Returns the first string literal in the first argument of an instrumentation call or NULL if there is none.
+	 **/
+	static const clang::StringLiteral* GetPatternArgument(clang::CallExpr *CallExpr);
 
-class HalsteadVisitor : public clang::RecursiveASTVisitor<HalsteadVisitor> {
-public:
-  //bool VisitAllOperatorsAndCount(CXXRecordDecl *Declaration);
-	explicit HalsteadVisitor(clang::ASTContext *Context);
+	/**
+	 * @brief The identity of a function across translation units, see PatternGraph::GetFunctionUSR() and PatternGraph::CalculateFunctionHash().
+	 **/
+	struct FunctionIdentity
+	{
+		uint64_t Hash;
+		Atom USR;
+	};
 
-	bool VisitBinaryOperator(clang::BinaryOperator *BinarOp);
-	bool VisitCallExpr(clang::CallExpr *CallExpr);
-	bool VisitUnaryOperator(clang::UnaryOperator *UnaryOperator);
-	bool VisitDeclStmt(clang::DeclStmt *DclStmt);
-	bool VisitCompoundAssignOperator(clang::CompoundAssignOperator *CompAsOp);
-	bool VisitMemberExpr(clang::MemberExpr *MemExpr);
-	bool VisitStringLiteral(clang::StringLiteral *StrgLit);
-	bool VisitCharacterLiteral(clang::CharacterLiteral *CharLit);
-	bool VisitVarDecl(clang::VarDecl *VrDcl);
-	bool VisitFunctionDecl(clang::FunctionDecl *FctDecl);
+	/**
+	 * @brief Returns the USR and its hash value of the function declaration.
+	 * Functions are usually called many times, so the identities are memoized for each canonical declaration.
+	 **/
+	const FunctionIdentity& GetFunctionIdentity(clang::FunctionDecl *Decl);
 
-	void IsStmtInAPatt(clang::Stmt *Stm, std::vector<HPCParallelPattern*> *isInPatterns);
-	void IsDeclInAPatt(clang::Decl *Dcl, std::vector<HPCParallelPattern*> *isInPatterns);
-	int countQual(clang::VarDecl* VDecl);
-	bool shouldVisitImplicitCode() const { return true; }
-private:
 	clang::ASTContext *Context;
-	Halstead* actHalstead;
+
+	TranslationUnitLog *Log;
+
+	bool CallsOnly;
+
+	/* The visitor is used for one translation unit only, so the declarations stay valid */
+	std::unordered_map<const clang::FunctionDecl*, FunctionIdentity> FunctionIdentities;
+
+	/* The identifiers of the names of the instrumentation functions in this translation unit */
+	const clang::IdentifierInfo* PatternBeginCXXName;
+	const clang::IdentifierInfo* PatternBeginCName;
+	const clang::IdentifierInfo* PatternEndCXXName;
+	const clang::IdentifierInfo* PatternEndCName;
+
+	llvm::DenseMap<const clang::FunctionDecl*, InstrumentationKind> InstrumentationKinds;
+
+	/* The offsets of the Halstead operators in the main file and their number */
+	std::vector<std::pair<unsigned, int>> Operators;
+
+	/* The pattern begins of the translation unit, numbered in the order of the log, see TranslationUnitLog::AddHalsteadOperators() */
+	struct RegionBounds
+	{
+		/* Refers to the string literal in the AST */
+		llvm::StringRef PatternID;
+		unsigned Begin = 0;
+		unsigned End = 0;
+		bool Closed = false;
+	};
+
+	std::vector<RegionBounds> Regions;
+
+	/* The file of the last resolved position, see GetPosition() */
+	clang::FileID PositionFileID;
+	Atom PositionFile = 0;
 };
 
 
 class HPCPatternInstrConsumer : public clang::ASTConsumer
 {
 public:
-	explicit HPCPatternInstrConsumer(clang::ASTContext *Context) : Visitor(Context)
+	/**
+	 * @param Session The session the log is replayed into, if no container is set with TranslationUnitLog::SetThreadSink().
+	 **/
+	explicit HPCPatternInstrConsumer(clang::ASTContext *Context, llvm::StringRef InFile, AnalysisSession *Session, bool CallsOnly = false) : Log(InFile.str()), Visitor(Context, &Log, CallsOnly), Context(Context), Session(Session), ParseStart(std::chrono::steady_clock::now()), Times(InFile.str())
 	{
 	}
+
+	/**
+	 * @brief Called by Sema if FrontendOptions::SkipFunctionBodies is set (see HPCPatternInstrAction::SetSkipHeaderBodies()).
+	 * The bodies of functions outside of the main file are skipped, since the visitor ignores them anyway.
+	 * The declarations are still parsed, so the calls in the main file are resolved as usual.
+	 *
+	 * @param Decl The declaration whose body is about to be parsed.
+	 *
+	 * @return True if the body is not parsed.
+	 **/
+	bool shouldSkipFunctionBody(clang::Decl *Decl) override;
+
+	/**
+	 * @brief Traverses the translation unit. The recorded TranslationUnitLog is replayed into the session immediately,
+	 * or handed to the container set with TranslationUnitLog::SetThreadSink() if the translation unit is analysed on a worker thread.
+	 **/
 	void HandleTranslationUnit(clang::ASTContext &Context);
 
 
 private:
+	TranslationUnitLog Log;
+
 	HPCPatternInstrVisitor Visitor;
+
+	clang::ASTContext *Context;
+
+	AnalysisSession *Session;
+
+	/* For the report of HPCPatternInstrAction::SetParseReport() */
+	std::chrono::steady_clock::time_point ParseStart;
+	unsigned NumSkippedBodies = 0;
+
+	/* For the -time-report */
+	TimeReport::TranslationUnit Times;
 };
 
-class HalsteadConsumer : public clang::ASTConsumer {
+class HPCPatternInstrAction : public clang::ASTFrontendAction
+{
 public:
-	explicit HalsteadConsumer(clang::ASTContext *Context) : HVisitor(Context)
+	/**
+	 * @param Session The session the results are added to. Without a session the logs have to be collected with TranslationUnitLog::SetThreadSink().
+	 **/
+	explicit HPCPatternInstrAction(AnalysisSession *Session = NULL) : Session(Session)
 	{
 	}
 
-  virtual void HandleTranslationUnit(clang::ASTContext &Context) {
-    // Traversing the translation unit decl via a RecursiveASTVisitor
-    // will visit all nodes in the AST.
-    HVisitor.TraverseDecl(Context.getTranslationUnitDecl());
-  }
-	// A RecursiveASTVisitor implementation.
+	virtual std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance &Compiler, llvm::StringRef InFile);
+
+	/**
+	 * @brief Enables the text prefilter for all following actions.
+	 * Before a translation unit is parsed, its main file is searched for the names of the instrumentation functions.
+	 * If there is none, only the function declarations and calls needed to link the call tree are extracted (see HPCPatternInstrVisitor).
+	 * The file is still parsed completely, since the callees of its calls are only known after semantic analysis. Only the traversal of the AST is narrower, so the speedup is limited to the traversal.
+	 * Instrumentation calls hidden in macros defined in headers are not found, so the prefilter is disabled by default.
+	 *
+	 * @param Enable True to enable the prefilter.
+	 **/
+	static void SetPrefilter(bool Enable);
+
+	/**
+	 * @brief Enables or disables skipping of the function bodies outside of the main file, enabled by default.
+	 * Only constexpr functions and functions with a deduced return type are always parsed completely.
+	 *
+	 * @param Enable True to skip the bodies.
+	 **/
+	static void SetSkipHeaderBodies(bool Enable);
+
+	/**
+	 * @brief Enables a report of the parse time and the number of skipped function bodies of each translation unit on stderr.
+	 *
+	 * @param Enable True to print the report.
+	 **/
+	static void SetParseReport(bool Enable);
+
+	/**
+	 * @brief Tells whether each translation unit has to be parsed again with a ParseBaselineAction after the analysis,
+	 * i.e. if the parse report is enabled and the function bodies are skipped.
+	 *
+	 * @return True if the baseline is needed.
+	 **/
+	static bool NeedsParseBaseline();
+
+	/**
+	 * @brief Describes the options which change the content of the recorded TranslationUnitLogs, i.e. the prefilter and the skipping of function bodies.
+	 * Logs recorded with a different mode must not be reused (see AnalysisCache).
+	 *
+	 * @return The description.
+	 **/
+	static std::string GetAnalysisMode();
+
+	/**
+	 * @brief Searches the source code for the names of the instrumentation functions, including comments and disabled code.
+	 *
+	 * @param Code The content of a source file.
+	 *
+	 * @return True if the code might contain an instrumentation call.
+	 **/
+	static bool MayContainInstrumentationCall(llvm::StringRef Code);
+
+protected:
+	/**
+	 * @brief Watches for a rejected precompiled header if the translation unit is parsed with one (see SharedPreamble::DetectRejection()).
+	 **/
+	bool BeginInvocation(clang::CompilerInstance &Compiler) override;
 
 private:
-		HalsteadVisitor HVisitor;
+	AnalysisSession *Session;
 };
 
-class HPCPatternInstrAction : public clang::ASTFrontendAction
+/**
+ * Parses a translation unit a second time without skipping any function body, which is the baseline for the report of HPCPatternInstrAction::SetParseReport().
+ * The parse time is printed next to the parse time of the preceding HPCPatternInstrAction on the same thread. The AST is not traversed.
+ */
+class ParseBaselineAction : public clang::ASTFrontendAction
 {
 public:
 	virtual std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance &Compiler, llvm::StringRef InFile);
 };
 
-
-class HalsteadClassAction : public clang::ASTFrontendAction {
+/**
+ * Creates a HPCPatternInstrAction for every translation unit the ClangTool runs on. All of them add their results to the same session.
+ */
+class HPCPatternInstrActionFactory : public clang::tooling::FrontendActionFactory
+{
 public:
-  virtual std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance &Compiler, llvm::StringRef InFile);
+	explicit HPCPatternInstrActionFactory(AnalysisSession *Session) : Session(Session)
+	{
+	}
+
+	std::unique_ptr<clang::FrontendAction> create() override
+	{
+		return std::unique_ptr<clang::FrontendAction>(new HPCPatternInstrAction(Session));
+	}
+
+private:
+	AnalysisSession *Session;
 };
+
@@ -2,17 +2,79 @@
 #include "HPCParallelPattern.h"
 #include "HPCError.h"
 #include <iostream>
-#include <regex>
 //#define PRINT_ONLYPATTERNDENUG
 
 
-/*
- * Regular Expressions
- */
-std::regex BeginParallelPatternRegex("([[:alnum:]]+)\\s([[:alnum:]]+)\\s([[:alnum:]]+)");
-std::regex EndParallelPatternRegex("([[:alnum:]]+)");
+static bool IsDescriptorChar(char C)
+{
+	return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') || (C >= '0' && C <= '9');
+}
+
+static bool IsDescriptorSpace(char C)
+{
+	return C == ' ' || C == '\t' || C == '\n' || C == '\r' || C == '\v' || C == '\f';
+}
 
+bool ParsePatternDescriptor(llvm::StringRef PatternInfoStr, PatternDescriptor& Descriptor, size_t& ErrorOffset, const char*& Error)
+{
+	static const char* MissingPart[] = { "expected the design space", "expected the pattern name", "expected the pattern identifier" };
 
+	llvm::StringRef Parts[3];
+	size_t Pos = 0;
+
+	for (int Part = 0; Part < 3; Part++)
+	{
+		size_t Begin = Pos;
+		while (Pos < PatternInfoStr.size() && IsDescriptorSpace(PatternInfoStr[Pos]))
+		{
+			Pos++;
+		}
+
+		/* The parts have to be separated, only the first one may start at the beginning of the string */
+		if (Part > 0 && Pos == Begin && Pos < PatternInfoStr.size())
+		{
+			ErrorOffset = Pos;
+			Error = "only letters and digits are allowed in the design space, the pattern name and the identifier";
+			return false;
+		}
+
+		size_t Start = Pos;
+		while (Pos < PatternInfoStr.size() && IsDescriptorChar(PatternInfoStr[Pos]))
+		{
+			Pos++;
+		}
+
+		if (Pos == Start)
+		{
+			ErrorOffset = Pos;
+			Error = Pos < PatternInfoStr.size() ? "only letters and digits are allowed in the design space, the pattern name and the identifier" : MissingPart[Part];
+			return false;
+		}
+
+		Parts[Part] = PatternInfoStr.slice(Start, Pos);
+	}
+
+	while (Pos < PatternInfoStr.size() && IsDescriptorSpace(PatternInfoStr[Pos]))
+	{
+		Pos++;
+	}
+
+	if (Pos < PatternInfoStr.size())
+	{
+		ErrorOffset = Pos;
+		Error = "unexpected characters after the pattern identifier";
+		return false;
+	}
+
+	Descriptor.DesignSp = StrToDesignSpace(Parts[0]);
+	Descriptor.PatternName = Parts[1];
+	Descriptor.PatternID = Parts[2];
+	return true;
+}
+
+HPCPatternBeginInstrHandler::HPCPatternBeginInstrHandler(AnalysisSession* Session) : Session(Session), CurrentFnEntry(NULL)
+{
+}
 
 /**
  * @brief Keep track of the currently encountered function.
@@ -25,25 +87,33 @@ void HPCPatternBeginInstrHandler::SetCurrentFnEntry(FunctionNode* FnEntry)
 }
 
  // describes what has to happen if we encounter the beginning of a pattern
-void HPCPatternBeginInstrHandler::run(const clang::ast_matchers::MatchFinder::MatchResult &Result)
+void HPCPatternBeginInstrHandler::run(llvm::StringRef PatternInfoStr)
 {
-	const clang::StringLiteral* patternstr = Result.Nodes.getNodeAs<clang::StringLiteral>("patternstr");
+	/* Parse the descriptor and save info*/
+	PatternDescriptor Descriptor;
+	size_t ErrorOffset;
+	const char* Error;
 
+	try{
+		if(!ParsePatternDescriptor(PatternInfoStr, Descriptor, ErrorOffset, Error)){
+			throw MalformedPatternDescriptorException(PatternInfoStr.str(), ErrorOffset, Error);
+		}
+	}
+	catch(MalformedPatternDescriptorException& e){
+		std::cout << e.what();
+		throw TerminateEarlyException();
+	}
 
-	/* Match Regex and save info*/
-	std::smatch MatchRes;
-	std::string PatternInfoStr = patternstr->getString().str();
-
-	std::regex_search(PatternInfoStr, MatchRes, BeginParallelPatternRegex);
+	DesignSpace DesignSp = Descriptor.DesignSp;
+	Atom PatternName = AtomTable::Intern(Descriptor.PatternName);
+	Atom PatternID = AtomTable::Intern(Descriptor.PatternID);
 
-	DesignSpace DesignSp = StrToDesignSpace(MatchRes[1].str());
-	std::string PatternName = MatchRes[2].str();
-	std::string PatternID = MatchRes[3].str();
+	PatternGraph* Graph = Session->GetGraph();
 
 	/*We look if this patternCodeRegion ID is already used*/
 	try{
-		if(PatternIDisUsed(PatternID)){
-			throw TooManyBeginsException(PatternID);
+		if(Graph->PatternIDisUsed(PatternID)){
+			throw TooManyBeginsException(Descriptor.PatternID.str());
 		}
 	}
 	catch(TooManyBeginsException& e){
@@ -51,23 +121,23 @@ void HPCPatternBeginInstrHandler::run(const clang::ast_matchers::MatchFinder::Ma
 		throw TerminateEarlyException();
 	}
 	/* Look if a pattern with this Design Space and Name already exists */
-	HPCParallelPattern* Pattern = PatternGraph::GetInstance()->GetPattern(DesignSp, PatternName);
+	HPCParallelPattern* Pattern = Graph->GetPattern(DesignSp, PatternName);
 
 	/*If Pattern does not exist register it.*/
 	if (Pattern == NULL)
 	{
-		Pattern = new HPCParallelPattern(DesignSp, PatternName);
-		PatternGraph::GetInstance()->RegisterPattern(Pattern);
+		Pattern = Graph->CreatePattern(DesignSp, PatternName);
+		Graph->RegisterPattern(Pattern);
 	}
 
 
 	/* Check if this code regions is part of an existing pattern occurrence */
-	PatternOccurrence* PatternOcc = PatternGraph::GetInstance()->GetPatternOccurrence(PatternID);
+	PatternOccurrence* PatternOcc = Graph->GetPatternOccurrence(PatternID);
 
 	if (PatternOcc == NULL)
 	{
-		PatternOcc = new PatternOccurrence(Pattern, PatternID);
-		PatternGraph::GetInstance()->RegisterPatternOccurrence(PatternOcc);
+		PatternOcc = Graph->CreatePatternOccurrence(Pattern, PatternID);
+		Graph->RegisterPatternOccurrence(PatternOcc);
 		Pattern->AddOccurrence(PatternOcc);
 	}
 	else
@@ -84,16 +154,13 @@ void HPCPatternBeginInstrHandler::run(const clang::ast_matchers::MatchFinder::Ma
 		}
 	}
 
-	/* register the PatternOcc in the Pattern Stack for the Halstead metric*/
-	OccStackForHalstead.push_back(PatternOcc);
-
 	/* Create a new object for pattern occurrence */
-	PatternCodeRegion* CodeRegion = new PatternCodeRegion(PatternOcc);
+	PatternCodeRegion* CodeRegion = Graph->CreatePatternCodeRegion(PatternOcc);
 	PatternOcc->AddCodeRegion(CodeRegion);
 
 
 	/* Connect the child and parent links between the objects */
-	PatternCodeRegion* Top = GetTopPatternStack();
+	PatternCodeRegion* Top = Session->GetTopPatternStack();
 
 	if (Top != NULL)
 	{
@@ -110,9 +177,9 @@ void HPCPatternBeginInstrHandler::run(const clang::ast_matchers::MatchFinder::Ma
 		CurrentFnEntry->registerPatChildrenToPatParents();
 	}
 
-	AddToPatternStack(CodeRegion);
+	Session->AddToPatternStack(CodeRegion);
 
-	PatternCodeRegion* OnlyPatternTop = GetTopOnlyPatternStack();
+	PatternCodeRegion* OnlyPatternTop = Session->GetTopOnlyPatternStack();
 
 	if(OnlyPatternTop != NULL)
 	{
@@ -121,10 +188,10 @@ void HPCPatternBeginInstrHandler::run(const clang::ast_matchers::MatchFinder::Ma
 	}
 	else
 	{
-		PatternGraph::GetInstance()->RegisterOnlyPatternRootNode(CodeRegion);
+		Graph->RegisterOnlyPatternRootNode(CodeRegion);
 	}
 
-	AddToOnlyPatternStack(CodeRegion);
+	Session->AddToOnlyPatternStack(CodeRegion);
 
 #if PRINT_DEBUG
 	Pattern->Print();
@@ -133,17 +200,19 @@ void HPCPatternBeginInstrHandler::run(const clang::ast_matchers::MatchFinder::Ma
 #endif
 }
 
-void HPCPatternEndInstrHandler::run(const clang::ast_matchers::MatchFinder::MatchResult &Result)
+HPCPatternEndInstrHandler::HPCPatternEndInstrHandler(AnalysisSession* Session) : Session(Session), CurrentFnEntry(NULL), LastPattern(NULL), LastOnlyPattern(NULL)
 {
-	const clang::StringLiteral* patternstr = Result.Nodes.getNodeAs<clang::StringLiteral>("patternstr");
+}
 
-	LastPatternID = patternstr->getString().str();
-	LastPattern = GetTopPatternStack();
+void HPCPatternEndInstrHandler::run(std::string PatternID)
+{
+	LastPatternID = PatternID;
+	LastPattern = Session->GetTopPatternStack();
 
-	RemoveFromPatternStack(LastPatternID);
+	Session->RemoveFromPatternStack(LastPatternID);
 
-	LastOnlyPattern = GetTopOnlyPatternStack();
-	RemoveFromOnlyPatternStack(LastPatternID);
+	LastOnlyPattern = Session->GetTopOnlyPatternStack();
+	Session->RemoveFromOnlyPatternStack(LastPatternID);
 }
 
 void HPCPatternEndInstrHandler::SetCurrentFnEntry(FunctionNode* FnEntry)
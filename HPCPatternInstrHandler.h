@@ -1,34 +1,68 @@
 #pragma once
 
 #include "HPCParallelPattern.h"
+#include "AnalysisSession.h"
 
-#include "clang/ASTMatchers/ASTMatchers.h"
-#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include <string>
+#include "llvm/ADT/StringRef.h"
 
 
 /**
- * This class handles the callback that is issued when a pattern begin instrumentation call is encountered and the string argument is matched.
+ * The parts of the string argument of a pattern begin call: "DesignSpace PatternName Identifier".
+ * The parts refer to the parsed string, so they are only valid as long as the string exists.
+ */
+struct PatternDescriptor
+{
+	DesignSpace DesignSp;
+	llvm::StringRef PatternName;
+	llvm::StringRef PatternID;
+};
+
+/**
+ * @brief Parses the string argument of a pattern begin call without allocating memory.
+ * The three parts consist of letters and digits and are separated by whitespace. Leading and trailing whitespace is ignored.
+ *
+ * @param PatternInfoStr The string argument of the pattern begin call.
+ * @param Descriptor The parts of the string, if it is well-formed.
+ * @param ErrorOffset The offset of the first character that does not fit, if it is malformed.
+ * @param Error A description of the error, if it is malformed.
+ *
+ * @return True if the string is well-formed.
+ **/
+bool ParsePatternDescriptor(llvm::StringRef PatternInfoStr, PatternDescriptor& Descriptor, size_t& ErrorOffset, const char*& Error);
+
+
+/**
+ * This class handles a pattern begin instrumentation call once its string argument is known.
  * It extracts all information about the pattern and patternoccurrence from the string argument and initiates creation of all involved objects.
  */
-class HPCPatternBeginInstrHandler : public clang::ast_matchers::MatchFinder::MatchCallback
+class HPCPatternBeginInstrHandler
 {
 public:
+	/**
+	 * @param Session The session whose graph and pattern stacks are modified.
+	 **/
+	explicit HPCPatternBeginInstrHandler(AnalysisSession* Session);
+
 	void SetCurrentFnEntry(FunctionNode* FnEntry);
 	/**
 	 * returns the pattern on top of the pattern stack. Is used to keept track within wich pattern we are while traversing.
 	 */
-	PatternCodeRegion* GetLastPattern() { return GetTopPatternStack(); };
+	PatternCodeRegion* GetLastPattern() { return Session->GetTopPatternStack(); };
 	/**
-	 * @brief Analyse the match results from the pattern begin matcher to extract information about the pattern.
+	 * @brief Analyse the string argument of the pattern begin call to extract information about the pattern.
 	 * After extracting design space, pattern name and pattern identifier, HPCParallelPattern and PatternOccurrence objects are looked up in the database.
 	 * If they do not already exist, they are created.
 	 * Then, a PatternCodeRegion object is created for this particular encounter.
 	 *
-	 * @param Result Match results from the pattern begin matcher.
+	 * The names are interned directly from the string, so nothing is copied for patterns and identifiers which are already known.
+	 *
+	 * @param PatternInfoStr The string argument of the pattern begin call.
 	 **/
-	virtual void run (const clang::ast_matchers::MatchFinder::MatchResult &Result);
+	void run (llvm::StringRef PatternInfoStr);
 
 private:
+	AnalysisSession* Session;
 	/**
 	 * Is used to keep track within which function we are while traversing.
 	 */
@@ -39,9 +73,14 @@ private:
 /**
  * See HPCPatternBeginInstrHandler and HPCPatternEndInstrHandler::run()
  */
-class HPCPatternEndInstrHandler : public clang::ast_matchers::MatchFinder::MatchCallback
+class HPCPatternEndInstrHandler
 {
 public:
+	/**
+	 * @param Session The session whose pattern stacks are modified.
+	 **/
+	explicit HPCPatternEndInstrHandler(AnalysisSession* Session);
+
 	void SetCurrentFnEntry(FunctionNode* FnEntry);
 	/**
 	 * Pattern end is closing a Pattern. Possibly a pattern within another pattern. This is used to get the outer pattern.
@@ -52,13 +91,14 @@ public:
 	 */
 	std::string GetLastPatternID(){ return LastPatternID;};
 	/**
-	 * @brief Extracts the pattern identifier string from the match results and removes the PatternCodeRegion from the pattern stack.
+	 * @brief Takes the pattern identifier string of the pattern end call and removes the PatternCodeRegion from the pattern stack.
 	 *
-	 * @param Result Match results from the pattern end matcher.
+	 * @param PatternID The string argument of the pattern end call.
 	 **/
-	virtual void run (const clang::ast_matchers::MatchFinder::MatchResult &Result);
+	void run (std::string PatternID);
 
 private:
+	AnalysisSession* Session;
 	/**
 	 * @brief See PatternBeginInstrHandler::SetCurrentFnEntry().
 	 *
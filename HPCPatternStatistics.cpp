@@ -8,7 +8,7 @@
 /*
  * Methods for the Cyclomatic Complexity Statistic
  */
-CyclomaticComplexityStatistic::CyclomaticComplexityStatistic() : VisitedNodes()
+CyclomaticComplexityStatistic::CyclomaticComplexityStatistic(PatternGraph* Graph) : VisitedNodes(), Graph(Graph)
 {
 
 }
@@ -67,7 +67,7 @@ bool CyclomaticComplexityStatistic::IsNodeVisited(PatternGraphNode* Node)
 int CyclomaticComplexityStatistic::CountEdges()
 {
 	/* Start the tree traversal from all functions */
-	std::vector<FunctionNode*> Functions = PatternGraph::GetInstance()->GetAllFunctions();
+	llvm::ArrayRef<FunctionNode*> Functions = Graph->GetAllFunctions();
 
 	int edges = 0;
 
@@ -110,15 +110,14 @@ int CyclomaticComplexityStatistic::CountEdges(PatternGraphNode* Current)
 
 int CyclomaticComplexityStatistic::CountNodes()
 {
-	std::vector<HPCParallelPattern*> Patterns = PatternGraph::GetInstance()->GetAllPatterns();
+	llvm::ArrayRef<HPCParallelPattern*> Patterns = Graph->GetAllPatterns();
 
 	int nodes = 0;
 
 	/* Count all occurrences for all patterns */
 	for (HPCParallelPattern* Pattern : Patterns)
 	{
-		std::vector<PatternCodeRegion*> CodeRegs = Pattern->GetCodeRegions();
-		nodes += CodeRegs.size();
+		nodes += Pattern->GetCodeRegions().size();
 	}
 
 	return nodes;
@@ -126,10 +125,10 @@ int CyclomaticComplexityStatistic::CountNodes()
 
 int CyclomaticComplexityStatistic::CountConnectedComponents()
 {
-	GraphAlgorithms::MarkConnectedComponents();
+	GraphAlgorithms::MarkConnectedComponents(Graph);
 
-	std::vector<PatternCodeRegion*> CodeRegs = PatternGraph::GetInstance()->GetAllPatternCodeRegions();
-	std::vector<FunctionNode*> Functions = PatternGraph::GetInstance()->GetAllFunctions();
+	CodeRegionRange CodeRegs = Graph->GetAllPatternCodeRegions();
+	llvm::ArrayRef<FunctionNode*> Functions = Graph->GetAllFunctions();
 
 	int ConnectedComponents = 0;
 
@@ -160,6 +159,11 @@ int CyclomaticComplexityStatistic::CountConnectedComponents()
 /*
  * Methods for the lines of code statistic
  */
+LinesOfCodeStatistic::LinesOfCodeStatistic(PatternGraph* Graph) : Graph(Graph)
+{
+
+}
+
 void LinesOfCodeStatistic::Calculate()
 {
 
@@ -167,13 +171,13 @@ void LinesOfCodeStatistic::Calculate()
 
 void LinesOfCodeStatistic::Print()
 {
-	std::vector<HPCParallelPattern*> Patterns = PatternGraph::GetInstance()->GetAllPatterns();
+	llvm::ArrayRef<HPCParallelPattern*> Patterns = Graph->GetAllPatterns();
 
 	for (HPCParallelPattern* Pattern : Patterns)
 	{
 		std::cout << "\033[33m" << Pattern->GetPatternName() << "\033[0m" << " has " << Pattern->GetTotalLinesOfCode() << " line(s) of code in total." << std::endl;
 
-		std::vector<PatternOccurrence*> Occurrences = Pattern->GetOccurrences();
+		llvm::ArrayRef<PatternOccurrence*> Occurrences = Pattern->GetOccurrences();
 		std::cout << Occurrences.size() << " occurrences in code." << std::endl;
 
 		for (PatternOccurrence* PatternOcc : Occurrences)
@@ -192,24 +196,30 @@ void LinesOfCodeStatistic::CSVExport(std::string FileName)
 
 	File << "Patternname" << CSV_SEPARATOR_CHAR << "NumRegions" << CSV_SEPARATOR_CHAR << "LOCByRegions" << CSV_SEPARATOR_CHAR << "TotalLOCs\n";
 
-	std::vector<HPCParallelPattern*> Patterns = PatternGraph::GetInstance()->GetAllPatterns();
+	llvm::ArrayRef<HPCParallelPattern*> Patterns = Graph->GetAllPatterns();
 
 	for (HPCParallelPattern* Pattern : Patterns)
 	{
 		File << Pattern->GetPatternName()  << CSV_SEPARATOR_CHAR;
 
-		std::vector<PatternCodeRegion*> PatternCodeRegions = Pattern->GetCodeRegions();
+		CodeRegionRange PatternCodeRegions = Pattern->GetCodeRegions();
 		File << PatternCodeRegions.size() << CSV_SEPARATOR_CHAR;
 
 		/* Print the list of lines of code for this pattern */
 		File << "\"";
 
-		for (unsigned long i = 0; i < PatternCodeRegions.size() - 1; i++)
+		bool First = true;
+		for (PatternCodeRegion* CodeReg : PatternCodeRegions)
 		{
-			File << PatternCodeRegions.at(i)->GetLinesOfCode() << ", ";
+			if (!First)
+			{
+				File << ", ";
+			}
+
+			File << CodeReg->GetLinesOfCode();
+			First = false;
 		}
 
-		File << PatternCodeRegions.at(PatternCodeRegions.size() - 1)->GetLinesOfCode();
 		File << "\"" << CSV_SEPARATOR_CHAR;
 
 		File << Pattern->GetTotalLinesOfCode() << "\n";
@@ -223,7 +233,7 @@ void LinesOfCodeStatistic::CSVExport(std::string FileName)
 /*
  * Methods for the simple pattern counter
  */
-SimplePatternCountStatistic::SimplePatternCountStatistic()
+SimplePatternCountStatistic::SimplePatternCountStatistic(PatternGraph* Graph) : Graph(Graph)
 {
 
 }
@@ -235,7 +245,7 @@ void SimplePatternCountStatistic::Calculate()
 
 void SimplePatternCountStatistic::Print()
 {
-	std::vector<HPCParallelPattern*> Patterns = PatternGraph::GetInstance()->GetAllPatterns();
+	llvm::ArrayRef<HPCParallelPattern*> Patterns = Graph->GetAllPatterns();
 
 	for (HPCParallelPattern* Pattern : Patterns)
 	{
@@ -250,7 +260,7 @@ void SimplePatternCountStatistic::CSVExport(std::string FileName)
 
 	File << "Patternname" << CSV_SEPARATOR_CHAR << "Count\n";
 
-	std::vector<HPCParallelPattern*> Patterns = PatternGraph::GetInstance()->GetAllPatterns();
+	llvm::ArrayRef<HPCParallelPattern*> Patterns = Graph->GetAllPatterns();
 
 	for (HPCParallelPattern* Pattern : Patterns)
 	{
@@ -261,14 +271,14 @@ void SimplePatternCountStatistic::CSVExport(std::string FileName)
 }
 
 
-FanInFanOutStatistic::FanInFanOutStatistic(int maxdepth) : FIFOCounter()
+FanInFanOutStatistic::FanInFanOutStatistic(PatternGraph* Graph, int maxdepth) : Graph(Graph), FIFOCounter()
 {
 	this->maxdepth = maxdepth;
 }
 
 void FanInFanOutStatistic::Calculate()
 {
-	std::vector<HPCParallelPattern*> Patterns = PatternGraph::GetInstance()->GetAllPatterns();
+	llvm::ArrayRef<HPCParallelPattern*> Patterns = Graph->GetAllPatterns();
 
 	for (HPCParallelPattern* Pattern : Patterns)
 	{
@@ -283,8 +293,13 @@ void FanInFanOutStatistic::Calculate()
 		std::vector<PatternOccurrence*> Parents;
 		std::vector<PatternOccurrence*> Children;
 
-		for (PatternCodeRegion* CodeReg : GetCodeRegions(Pattern))
+		for (PatternCodeRegion* CodeReg : Pattern->GetCodeRegions())
 		{
+			/* Only the code regions which are suited for statistics that need clear nesting are counted, see FanInFanOutStatistic::GetCodeRegions() */
+			if (!CodeReg->isSuitedForNestingStatistics)
+			{
+				continue;
+			}
 #ifdef PRINT_DEBUG
 			CodeReg->Print();
 			std::cout << std::endl;
@@ -387,7 +402,7 @@ void FanInFanOutStatistic::FindParentPatterns(PatternCodeRegion* Start, std::vec
 {
 	/* Find the parent pattern code regions using API functionality */
 	std::vector<PatternCodeRegion*> CodeRegions;
-	GraphAlgorithms::FindParentPatternCodeRegions(Start, CodeRegions, maxdepth);
+	GraphAlgorithms::FindParentPatternCodeRegions(Graph, Start, CodeRegions, maxdepth);
 
 	int i = 0;
 	for(PatternCodeRegion* CodeReg : CodeRegions){
@@ -406,7 +421,7 @@ void FanInFanOutStatistic::FindChildPatterns(PatternCodeRegion* Start, std::vect
 {
 	/* Find child pattern code regions using API */
 	std::vector<PatternCodeRegion*> CodeRegions;
-	GraphAlgorithms::FindChildPatternCodeRegions(Start, CodeRegions, maxdepth);
+	GraphAlgorithms::FindChildPatternCodeRegions(Graph, Start, CodeRegions, maxdepth);
 
 	std::vector<PatternOccurrence*> TempChildren = PatternHelpers::GetPatternOccurrences(CodeRegions, true);
 
@@ -416,7 +431,6 @@ void FanInFanOutStatistic::FindChildPatterns(PatternCodeRegion* Start, std::vect
 
 Halstead::Halstead () {
 	int numOfOperators = 0;
-	//clang::tooling::runToolOnCode(new HalsteadClassAction, "main.cpp");
 }
 
 void Halstead::Calculate(){
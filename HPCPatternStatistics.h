@@ -15,6 +15,7 @@
 /**
  * Abstract class for pattern statistics.
  * Statistics have to inherit from this class and implement the virtual methods.
+ * Statistics which need the patterns or the functions of the analysis get the PatternGraph of the AnalysisSession in their constructor.
  */
 class HPCPatternStatistic
 {
@@ -48,7 +49,7 @@ public:
 class CyclomaticComplexityStatistic : public HPCPatternStatistic
 {
 public:
-	CyclomaticComplexityStatistic();
+	CyclomaticComplexityStatistic(PatternGraph* Graph);
 
 	/**
 	 * @brief Calls CyclomaticComplexityStatistic::CountEdges(), CyclomaticComplexityStatistic::CountNodes() and CyclomaticComplexityStatistic::CountConnectedComponents() to calculate the Cyclomatic Complexity Statistic C = (Edges - Nodes) + 2 * ConnectedComponents
@@ -113,6 +114,8 @@ private:
 
 	void MarkConnectedComponent(PatternGraphNode * Node, int ComponentID);
 
+	PatternGraph* Graph;
+
 	int Nodes, Edges, ConnectedComponents = 0;
 
 	int CyclomaticComplexity = 0;
@@ -125,6 +128,8 @@ private:
 class LinesOfCodeStatistic : public HPCPatternStatistic
 {
 public:
+	LinesOfCodeStatistic(PatternGraph* Graph);
+
 	void Calculate();
 	/**
 	 * @brief Prints statistics about lines of code for each HPCParallelPattern and PatternOccurrence.
@@ -136,6 +141,9 @@ public:
 	 * @param FileName File name of the output file.
 	 **/
 	void CSVExport(std::string FileName);
+
+private:
+	PatternGraph* Graph;
 };
 
 
@@ -145,7 +153,7 @@ public:
 class SimplePatternCountStatistic : public HPCPatternStatistic
 {
 public:
-	SimplePatternCountStatistic();
+	SimplePatternCountStatistic(PatternGraph* Graph);
 	/**
 	 * @brief Dummy function.
 	 */
@@ -160,6 +168,9 @@ public:
 	 * @param FileName File name of the output file.
 	 **/
 	void CSVExport(std::string FileName);
+
+private:
+	PatternGraph* Graph;
 };
 
 
@@ -175,9 +186,10 @@ public:
 	/**
 	 * @brief Constructor for the Fan-In Fan-Out statistic.
 	 *
+	 * @param Graph The graph of the analysis.
 	 * @param maxdepth The maximum recursion depth when descending in the tree.
 	 **/
-	FanInFanOutStatistic(int maxdepth);
+	FanInFanOutStatistic(PatternGraph* Graph, int maxdepth);
 	/**
 	 * @brief Calculates the Fan-In and Fan-Out statistic for each Pattern.
 	 * First, all children and parents for all PatternOccurrence and PatternCodeRegions are gathered.
@@ -241,6 +253,8 @@ private:
 	 **/
 	void FindChildPatterns(PatternCodeRegion* Start, std::vector<PatternOccurrence*>& Children, int maxdepth);
 
+	PatternGraph* Graph;
+
 	int maxdepth;
 	std::vector<HPCParallelPattern*> Pattern;
 
@@ -7,15 +7,25 @@
 #include "SimilarityMetrics.h"
 
 #include "ToolInformation.h"
+#include "ParallelAnalysis.h"
+#include "AnalysisCache.h"
+#include "SharedPreamble.h"
+#include "GraphSnapshot.h"
+#include "AnalysisSession.h"
+#include "AnalysisResult.h"
+#include "TimeReport.h"
 #ifndef HPCRUNNINGSTATS_H
   #include "HPCRunningStats.h"
 #endif
 //#include "HPCRunningStats.h"
 
 #include <iostream>
+#include <memory>
+#include <thread>
 #include "clang/Tooling/Tooling.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 
 #ifndef HPCERROR_H
@@ -49,7 +59,8 @@ int  MAX_DEPTH = 8;
  *  A pattern occurrence can rather consist of many PatternCodeRegion with the same identifier.
  * -# The code regions instrumented in the code are represnted by PatternCodeRegion objects in our tool. Every code region belongs to an occurrence which 'has' a pattern.
  *
- * Another central class is the PatternGraph singleton class, which holds structual information about the patterns extracted from the analysed sourcecode. It provides access to lists of all patterns, all occurrences and all code regions. Further, it holds a reference to a designated root node for tree or analysis purposes.
+ * Another central class is the PatternGraph class, which holds structual information about the patterns extracted from the analysed sourcecode. It provides access to lists of all patterns, all occurrences and all code regions. Further, it holds a reference to a designated root node for tree or analysis purposes.
+ * The PatternGraph, the CallTree and the pattern stacks of one analysis are owned by an AnalysisSession, which is handed to the FrontendActions, the statistics and the tree printers.
  *
  * Own statistics or similarity measures can easily be implemented. Statistics should inherit from HPCPatternStatistic and similarity measures from SimilarityMeasure. The statistic classes can then be registered in the tool's main function, where they are initialised and the calculations are executed.
  *
@@ -62,13 +73,17 @@ static llvm::cl::OptionCategory HPCPatternToolCategory("HPC pattern tool options
 
 static llvm::cl::extrahelp CommonHelp(clang::tooling::CommonOptionsParser::HelpMessage);
 
+/* The options for the output are available in the merge subcommand as well */
+static llvm::cl::SubCommand MergeCommand("merge", "Combines the fragment files of a sharded analysis (see --shard) and prints the trees and statistics");
+static llvm::cl::list<std::string> FragmentFiles(llvm::cl::Positional, llvm::cl::desc("<fragment files>"), llvm::cl::sub(MergeCommand));
+
 static llvm::cl::OptionCategory onlyPattern("Patterntree without function calls");
 static llvm::cl::extrahelp Help("-onlyPattern Use this flag, if you want to see the Patterntree without function calls\n \n");
-static llvm::cl::opt<bool> OnlyPatterns("onlyPattern", llvm::cl::cat(onlyPattern));
+static llvm::cl::opt<bool> OnlyPatterns("onlyPattern", llvm::cl::cat(onlyPattern), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
 
 static llvm::cl::OptionCategory noTree("Output without the relation tree");
 static llvm::cl::extrahelp HelpNoTree("-noTree Use this flag, if you don't want to see tree\n \n");
-static llvm::cl::opt<bool> NoTree("noTree", llvm::cl::cat(noTree));
+static llvm::cl::opt<bool> NoTree("noTree", llvm::cl::cat(noTree), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
 
 static llvm::cl::OptionCategory useSpecFiles("Only traverse certain Files");
 static llvm::cl::extrahelp HelpUseSpecFiles("-useSpecFiles Use this Flag, if you want to traverse certain files instead of a all Files within the compilation data base.");
@@ -76,7 +91,7 @@ static llvm::cl::opt<bool> UseSpecFiles("useSpecFiles", llvm::cl::cat(useSpecFil
 
 static llvm::cl::OptionCategory maxTreeDisplayDepth("Sets maximal depth to display the tree");
 static llvm::cl::extrahelp HelpMaxTreeDisplayDepth("This only changes the depth with which the tree is displayed. The other statistics are still using the whole tree.");
-static llvm::cl::opt<unsigned int> MaxTreeDisplayDepth("maxTreeDisplayDepth", llvm::cl::cat(maxTreeDisplayDepth));
+static llvm::cl::opt<unsigned int> MaxTreeDisplayDepth("maxTreeDisplayDepth", llvm::cl::cat(maxTreeDisplayDepth), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
 
 static llvm::cl::OptionCategory displayCompilationsList("Displays every File in the compilation database");
 static llvm::cl::extrahelp HelpDisplayCompilationsList("Use this option to be shure that every file which you want to analyze is in the compilation database. If not ur file is not analyzed by the tool and you should add this file in your compile_commands.json file");
@@ -88,11 +103,314 @@ static llvm::cl::opt<bool> PintVersion("pintVersion", llvm::cl::cat(pintVersion)
 
 static llvm::cl::OptionCategory relationTree("Output the relation tree");
 static llvm::cl::extrahelp HelpRelationTree("-relationTree Use this flag, if you want to see the relation tree\n \n");
-static llvm::cl::opt<bool> RelationTree("relationTree", llvm::cl::cat(noTree));
+static llvm::cl::opt<bool> RelationTree("relationTree", llvm::cl::cat(noTree), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
+
+static llvm::cl::OptionCategory jobs("Number of translation units analysed in parallel");
+static llvm::cl::extrahelp HelpJobs("-j <N> Use this option to parse and analyse N translation units at the same time. With -j 0 the number of hardware threads is used. The output is the same as without this option.\n \n");
+static llvm::cl::opt<unsigned int> Jobs("j", llvm::cl::init(1), llvm::cl::cat(jobs));
+
+static llvm::cl::OptionCategory cacheDir("Directory for the cached results of the translation units");
+static llvm::cl::extrahelp HelpCacheDir("-cacheDir=<dir> Use this option to store the results of every translation unit in <dir>. In the next run, only files which changed (or whose headers or compile commands changed) are parsed again.\n \n");
+static llvm::cl::opt<std::string> CacheDir("cacheDir", llvm::cl::cat(cacheDir));
+
+static llvm::cl::OptionCategory emitGraph("Writes the pattern graph and the call tree to a file");
+static llvm::cl::extrahelp HelpEmitGraph("--emit-graph=<file> Use this option to save the results of the analysis in <file>. The file can be used with --load-graph.\n \n");
+static llvm::cl::opt<std::string> EmitGraph("emit-graph", llvm::cl::cat(emitGraph), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
+
+static llvm::cl::OptionCategory loadGraph("Reads the pattern graph and the call tree from a file instead of analysing the code");
+static llvm::cl::extrahelp HelpLoadGraph("--load-graph=<file> Use this option to print the trees and statistics of a file written with --emit-graph. No source code is parsed, so no compilation database is needed.\n \n");
+static llvm::cl::opt<std::string> LoadGraph("load-graph", llvm::cl::cat(loadGraph));
+
+static llvm::cl::OptionCategory prefilter("Restricts the traversal of files without instrumentation calls");
+static llvm::cl::extrahelp HelpPrefilter("-prefilter Use this flag to search every file for the names of the instrumentation functions before it is parsed. Files without these names are still parsed completely, but only their function declarations and calls are extracted. The speedup is limited to the traversal: the declarations in headers are not visited and no operators are counted, but the parsing, which usually takes most of the time, is not shortened. Instrumentation calls within macros which are defined in headers are not found.\n \n");
+static llvm::cl::opt<bool> Prefilter("prefilter", llvm::cl::cat(prefilter));
+
+static llvm::cl::OptionCategory noBodySkipping("Parses the function bodies in headers");
+static llvm::cl::extrahelp HelpNoBodySkipping("-noBodySkipping By default the bodies of functions outside of the analysed file are not parsed, since they do not contain anything the tool uses. Use this flag to parse them anyway, e.g. to compare the parse times.\n \n");
+static llvm::cl::opt<bool> NoBodySkipping("noBodySkipping", llvm::cl::cat(noBodySkipping));
+
+static llvm::cl::OptionCategory parseReport("Prints the parse time of every file");
+static llvm::cl::extrahelp HelpParseReport("-parseReport Use this flag to print the parse time and the number of skipped function bodies of every file to stderr. Every file is parsed a second time without skipping to report the time saved by skipping, so the run takes longer.\n \n");
+static llvm::cl::opt<bool> ParseReport("parseReport", llvm::cl::cat(parseReport));
+
+static llvm::cl::OptionCategory preambleHeader("Headers which are precompiled once for all files");
+static llvm::cl::extrahelp HelpPreambleHeader("-preambleHeader=<header> Use this option (several times) to precompile headers which are included by all files, e.g. -preambleHeader=PatternInstrumentation.h -preambleHeader=\"<string>\". The precompiled header is built with the compile command of the first file. Files with different compile options are parsed without it.\n \n");
+static llvm::cl::list<std::string> PreambleHeaders("preambleHeader", llvm::cl::cat(preambleHeader));
+
+static llvm::cl::OptionCategory shard("Analyses only a part of the files and writes the results to a fragment file");
+static llvm::cl::extrahelp HelpShard("--shard=<i>/<N> Use this option to split the analysis of a large code into N parts, e.g. on different nodes of a cluster. Only every N-th file of the compilation database, starting with file i (0 <= i < N), is analysed. The results are written to a fragment file instead of being printed. Combine the fragments of all shards with \"HPC-pattern-tool merge <fragments>\".\n \n");
+static llvm::cl::opt<std::string> Shard("shard", llvm::cl::cat(shard));
+
+static llvm::cl::OptionCategory emitFragment("File name of the fragment of a shard");
+static llvm::cl::extrahelp HelpEmitFragment("--emit-fragment=<file> Use this option together with --shard to set the file name of the fragment. The default is fragment-<i>-of-<N>.pint.\n \n");
+static llvm::cl::opt<std::string> EmitFragment("emit-fragment", llvm::cl::cat(emitFragment));
+
+static llvm::cl::OptionCategory timeReport("Prints the time spent in the phases of the tool");
+static llvm::cl::extrahelp HelpTimeReport("-time-report Use this flag to print the wall and CPU time of every phase of the run, the slowest translation units, some counters (visited call expressions, registered functions, call tree nodes, matched pattern begins and ends) and the peak memory usage to stderr when the tool exits.\n \n");
+static llvm::cl::opt<bool> TimeReportFlag("time-report", llvm::cl::cat(timeReport), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
+
+static llvm::cl::OptionCategory timeReportJSON("Writes the time report to a JSON file");
+static llvm::cl::extrahelp HelpTimeReportJSON("-time-report-json=<file> Use this option to write the time report, including the times of all translation units, to <file>, e.g. to compare runs with a script.\n \n");
+static llvm::cl::opt<std::string> TimeReportJSONFile("time-report-json", llvm::cl::cat(timeReportJSON), llvm::cl::sub(*llvm::cl::TopLevelSubCommand), llvm::cl::sub(MergeCommand));
 
 Halstead* actHalstead = new Halstead();
 
-static HPCPatternStatistic* Statistics[] = { new SimplePatternCountStatistic(), new FanInFanOutStatistic(20), new LinesOfCodeStatistic(), new CyclomaticComplexityStatistic(), actHalstead };
+/**
+ * @brief Prints the call tree and the relation tree (depending on the flags) and calculates, prints and exports the statistics.
+ * Only the PatternGraph and the CallTree of the session are used, so this works the same after an analysis and after loading a GraphSnapshot.
+ *
+ * @param Session The session holding the results of the analysis.
+ **/
+static void PrintTreesAndStatistics(AnalysisSession* Session)
+{
+	PatternGraph* Graph = Session->GetGraph();
+	HPCPatternStatistic* Statistics[] = { new SimplePatternCountStatistic(Graph), new FanInFanOutStatistic(Graph, 20), new LinesOfCodeStatistic(Graph), new CyclomaticComplexityStatistic(Graph), actHalstead };
+
+	/* The graph does not change anymore, the statistics use the frozen graph */
+	{
+		TimeReport::Phase Phase("Freeze graph");
+		Graph->Freeze();
+	}
+
+	if(!NoTree.getValue()){
+		int mxdspldpth = MaxTreeDisplayDepth.getValue();
+		if(RelationTree.getValue())
+		{
+			TimeReport::Phase Phase("PrintRelationTree");
+			CallTreeVisualisation::PrintRelationTree(mxdspldpth, Graph, OnlyPatterns.getValue());
+		}
+
+		TimeReport::Phase Phase("PrintCallTree");
+		CallTreeVisualisation::PrintCallTree(mxdspldpth, Session->GetCallTree(), OnlyPatterns.getValue());
+	}
+
+	{
+		TimeReport::Phase Phase("Statistics");
+		for (HPCPatternStatistic* Stat : Statistics)
+		{
+			std::cout << std::endl << std::endl;
+			Stat->Calculate();
+			Stat->Print();
+		}
+	}
+
+	TimeReport::Phase Phase("CSV export");
+	Statistics[0]->CSVExport("Counts.csv");
+	Statistics[1]->CSVExport("FIFO.csv");
+	Statistics[2]->CSVExport("LOC.csv");
+}
+
+/**
+ * @brief Prints and writes the TimeReport when main() returns, so every way out of the tool is covered.
+ * The phases in main() are ended before, since they are destroyed first.
+ **/
+struct TimeReportPrinter
+{
+	/**
+	 * @brief Enables the TimeReport, if requested. Has to be called after the options are parsed.
+	 **/
+	void EnableIfRequested()
+	{
+		TimeReport::Enable(TimeReportFlag.getValue() || !TimeReportJSONFile.empty());
+	}
+
+	~TimeReportPrinter()
+	{
+		if(!TimeReport::IsEnabled()){
+			return;
+		}
+
+		std::cout.flush();
+		if(TimeReportFlag.getValue()){
+			TimeReport::Print(llvm::errs());
+		}
+		if(!TimeReportJSONFile.empty() && !TimeReport::WriteJSON(TimeReportJSONFile.getValue())){
+			llvm::errs() << "The time report could not be written to " << TimeReportJSONFile.getValue() << "\n";
+		}
+	}
+};
+
+/**
+ * @brief Checks for --load-graph before the options are parsed, because in this mode there is no compilation database and no source file.
+ **/
+static bool HasLoadGraphArgument(int argc, const char** argv)
+{
+	for(int i = 1; i < argc; i++){
+		llvm::StringRef Arg(argv[i]);
+		if(Arg.startswith("-load-graph") || Arg.startswith("--load-graph")){
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Checks for the merge subcommand, which combines fragment files instead of analysing source files.
+ **/
+static bool IsMergeCommand(int argc, const char** argv)
+{
+	return argc > 1 && llvm::StringRef(argv[1]) == "merge";
+}
+
+/**
+ * @brief Parses the argument of --shard.
+ *
+ * @return False if the argument is not of the form i/N with 0 <= i < N.
+ **/
+static bool ParseShard(llvm::StringRef Arg, uint32_t& ShardIdx, uint32_t& NumShards)
+{
+	std::pair<llvm::StringRef, llvm::StringRef> Parts = Arg.split('/');
+	if(Parts.first.getAsInteger(10, ShardIdx) || Parts.second.getAsInteger(10, NumShards)){
+		return false;
+	}
+	return ShardIdx < NumShards;
+}
+
+/**
+ * @brief Sets up the call tree, checks it and prints the trees and statistics. This is the same for a normal analysis and for merged fragments.
+ *
+ * @param Session The session holding the results of the analysis.
+ * @param RetCode The return code of the analysis.
+ *
+ * @return The return code of the tool.
+ **/
+static int FinishAnalysis(AnalysisSession* Session, int RetCode)
+{
+	CallTree* ClTre = Session->GetCallTree();
+
+	try{
+      #ifdef DEBUG
+        std::cout << "\nPrinting out DeclarationVector: " << std::endl;
+        for(CallTreeNode* Node : *ClTre->GetDeclarationVector())
+        {
+          std::cout << *Node->GetID() << " " << Node->GetNodeType()<< std::endl;
+          for(CallTreeNode* Callee : Node->GetCallees()){
+            std::cout << "--> " << *Callee->GetID() << " " << Callee->GetNodeType()<< std::endl;
+          }
+        }
+      #endif
+      if(!NoTree.getValue()){
+        {
+          TimeReport::Phase Phase("appendAllDeclToCallTree");
+          ClTre->appendAllDeclToCallTree(ClTre->getRoot());
+        }
+        TimeReport::Phase Phase("setUpTree");
+        ClTre->setUpTree();
+      }
+	}
+	catch(std::exception& terminate){
+		std::cout << terminate.what();
+    return 0;
+	}
+    try{
+      ClTre->lookIfTreeIsCorrect();
+    }
+    catch(TooManyBeginsException& begins){
+      begins.what();
+      return 0;
+    }
+		if(!EmitGraph.empty()){
+			try{
+				TimeReport::Phase Phase("Emit graph");
+				GraphSnapshot::Emit(Session, EmitGraph.getValue(), !NoTree.getValue());
+			}
+			catch(GraphSnapshotException& e){
+				std::cout << e.what();
+				return 1;
+			}
+		}
+
+		PrintTreesAndStatistics(Session);
+
+		/* Similarity Measures
+		std::vector<HPCParallelPattern*> SimPatterns;
+
+		HPCParallelPattern* IMVI = Session->GetGraph()->GetPattern(DesignSpace::ImplementationMechanism, "VariableIncrement");
+		HPCParallelPattern* FCGT = Session->GetGraph()->GetPattern(DesignSpace::FindingConcurrency, "GroupTask");
+		HPCParallelPattern* IMCO = Session->GetGraph()->GetPattern(DesignSpace::ImplementationMechanism, "Communication");
+		HPCParallelPattern* IMSY = Session->GetGraph()->GetPattern(DesignSpace::ImplementationMechanism, "Synchronization");
+
+		SimPatterns.push_back(IMCO);
+		SimPatterns.push_back(IMSY);
+
+		JaccardSimilarityStatistic Jaccard(Session->GetGraph(), SimPatterns, 2, 4, GraphSearchDirection::DIR_Parents, SimilarityCriterion::Pattern, 1000);
+
+		Jaccard.Calculate();
+		Jaccard.Print();
+	*/
+		return RetCode; //&& halstead;
+}
+
+/**
+ * @brief Combines the fragment files of a sharded analysis and finishes the analysis like a normal run.
+ * The fragments have to belong to the same analysis, missing shards are reported.
+ *
+ * @param Session The session the fragments are replayed into.
+ * @param FragmentFiles The fragment files.
+ *
+ * @return The return code of the tool.
+ **/
+static int MergeFragments(AnalysisSession* Session, const std::vector<std::string>& FragmentFiles)
+{
+	if(FragmentFiles.empty()){
+		std::cout << "Usage: HPC-pattern-tool merge <fragment files> [options]" << '\n';
+		return 1;
+	}
+
+	AnalysisResult Result;
+	std::vector<bool> HaveShard;
+	uint32_t NumShards = 0;
+	uint32_t NumFiles = 0;
+
+	for(const std::string& FragmentFile : FragmentFiles){
+		AnalysisResult Fragment;
+		uint32_t FragmentShardIdx, FragmentNumShards, FragmentNumFiles;
+
+		try{
+			TimeReport::Phase Phase("Load fragments");
+			AnalysisResult::Load(FragmentFile, Fragment, FragmentShardIdx, FragmentNumShards, FragmentNumFiles);
+		}
+		catch(ResultFragmentException& e){
+			std::cout << e.what();
+			return 1;
+		}
+
+		if(HaveShard.empty()){
+			NumShards = FragmentNumShards;
+			NumFiles = FragmentNumFiles;
+			HaveShard.assign(NumShards, false);
+		}
+		else if(FragmentNumShards != NumShards || FragmentNumFiles != NumFiles){
+			std::cout << "The fragment " << FragmentFile << " belongs to a different analysis (" << FragmentNumShards << " shards of " << FragmentNumFiles << " files instead of " << NumShards << " shards of " << NumFiles << " files)." << '\n';
+			return 1;
+		}
+
+		if(HaveShard[FragmentShardIdx]){
+			std::cout << "The fragment " << FragmentFile << " contains shard " << FragmentShardIdx << "/" << NumShards << ", which is already given by another fragment." << '\n';
+			return 1;
+		}
+
+		HaveShard[FragmentShardIdx] = true;
+		Result.Merge(std::move(Fragment));
+	}
+
+	for(uint32_t ShardIdx = 0; ShardIdx < NumShards; ShardIdx++){
+		if(!HaveShard[ShardIdx]){
+			llvm::errs() << "Warning: the fragment of shard " << ShardIdx << "/" << NumShards << " is missing, its files are not part of the results\n";
+		}
+	}
+
+	try{
+		TimeReport::Phase Phase("Replay");
+		Result.Replay(Session);
+	}
+	catch(std::exception& terminate){
+		std::cout << terminate.what();
+		return 0;
+	}
+
+	return FinishAnalysis(Session, 0);
+}
 
 /**
  * @brief Tool entry point. The tool's entry point which calls the FrontEndAction on the code.
@@ -104,6 +422,41 @@ int main (int argc, const char** argv)
   setCommandArguments(OnlyPatterns.getValue(), NoTree.getValue(), UseSpecFiles.getValue(), MaxTreeDisplayDepth.getValue(), DisplayCompilationsList.getValue(), PintVersion.getValue(), RelationTree.getValue());
 	MaxTreeDisplayDepth.setInitialValue(MAX_DEPTH);
 
+	AnalysisSession Session;
+	TimeReportPrinter ReportPrinter;
+
+	if(IsMergeCommand(argc, argv)){
+		/* The first argument selects the subcommand, so only the options of MergeCommand are accepted */
+		llvm::cl::ParseCommandLineOptions(argc, argv);
+		ReportPrinter.EnableIfRequested();
+		Session.SetHalstead(actHalstead);
+		return MergeFragments(&Session, std::vector<std::string>(FragmentFiles.begin(), FragmentFiles.end()));
+	}
+
+	if(HasLoadGraphArgument(argc, argv)){
+		llvm::cl::ParseCommandLineOptions(argc, argv);
+		ReportPrinter.EnableIfRequested();
+		Session.SetHalstead(actHalstead);
+
+		bool TreeIsSetUp;
+		try{
+			TimeReport::Phase Phase("Load graph");
+			TreeIsSetUp = GraphSnapshot::Load(&Session, LoadGraph.getValue());
+		}
+		catch(GraphSnapshotException& e){
+			std::cout << e.what();
+			return 1;
+		}
+
+		if(!TreeIsSetUp && !NoTree.getValue()){
+			std::cout << "The graph was written with -noTree, so there is no call tree to print. Use -noTree to see the statistics." << '\n';
+			return 1;
+		}
+
+		PrintTreesAndStatistics(&Session);
+		return 0;
+	}
+
 		clang::tooling::CommonOptionsParser OptsParserVersion(argc, argv, pintVersion);
 
 	if(PintVersion.getValue()){
@@ -111,6 +464,7 @@ int main (int argc, const char** argv)
 	}
 	else{
 		clang::tooling::CommonOptionsParser OptsParser(argc, argv, HPCPatternToolCategory);
+		ReportPrinter.EnableIfRequested();
 		std::vector<std::string> analyseList;
 		if(UseSpecFiles.getValue()){
 			analyseList = OptsParser.getSourcePathList();
@@ -149,81 +503,96 @@ int main (int argc, const char** argv)
 
 		clang::tooling::ArgumentsAdjuster ArgsAdjuster = clang::tooling::getInsertArgumentAdjuster(Arguments, clang::tooling::ArgumentInsertPosition::END);
 		HPCPatternTool.appendArgumentsAdjuster(ArgsAdjuster);
-		setActualHalstead(actHalstead);
+		Session.SetHalstead(actHalstead);
+		HPCPatternInstrAction::SetPrefilter(Prefilter.getValue());
+		HPCPatternInstrAction::SetSkipHeaderBodies(!NoBodySkipping.getValue());
+		HPCPatternInstrAction::SetParseReport(ParseReport.getValue());
 
 		/* Run the tool with options and source files provided */
 		int retcode = 0;
 		try{
-			retcode = HPCPatternTool.run(clang::tooling::newFrontendActionFactory<HPCPatternInstrAction>().get());
+			unsigned int NumJobs = Jobs.getValue();
+			if(NumJobs == 0){
+				NumJobs = std::max(1u, std::thread::hardware_concurrency());
+			}
 
-      #ifdef DEBUG
-        std::cout << "\nPrinting out DeclarationVector: " << std::endl;
-        for(CallTreeNode* Node : *ClTre->GetDeclarationVector())
-        {
-          std::cout << *Node->GetID() << " " << Node->GetNodeType()<< std::endl;
-          for(auto CalleeEntry = (Node->GetCallees())->begin() ; CalleeEntry != (Node->GetCallees())->end();){
-            std::cout << "--> " << *(CalleeEntry->second)->GetID() << " " << (CalleeEntry->second)->GetNodeType()<< std::endl;
-            CalleeEntry++;
-          }
-        }
-      #endif
-      if(!NoTree.getValue()){
-        ClTre->appendAllDeclToCallTree(ClTre->getRoot(), MAX_DEPTH);
-        ClTre->setUpTree();
-      }
+			SharedPreamble Preamble(PreambleHeaders);
+			bool PreambleIsBuilt = false;
+			if(!PreambleHeaders.empty()){
+				TimeReport::Phase Phase("Build preamble");
+				PreambleIsBuilt = Preamble.Build(OptsParser.getCompilations(), analyseList, ArgsAdjuster);
+			}
+
+			if(!Shard.empty()){
+				uint32_t ShardIdx, NumShards;
+				if(!ParseShard(Shard.getValue(), ShardIdx, NumShards)){
+					std::cout << "The argument of --shard has to be <i>/<N> with 0 <= i < N, e.g. --shard=0/4." << '\n';
+					return 1;
+				}
+
+				/* Every N-th file, so the shards get a similar mix of small and large files */
+				std::vector<uint32_t> ShardFiles;
+				for(uint32_t FileIdx = ShardIdx; FileIdx < analyseList.size(); FileIdx += NumShards){
+					ShardFiles.push_back(FileIdx);
+				}
+
+				std::unique_ptr<AnalysisCache> Cache;
+				if(!CacheDir.empty()){
+					Cache.reset(new AnalysisCache(CacheDir.getValue(), OptsParser.getCompilations(), ArgsAdjuster));
+				}
+
+				AnalysisResult Result;
+				{
+					TimeReport::Phase Phase("Analysis");
+					retcode = CollectAnalysisResult(OptsParser.getCompilations(), analyseList, ShardFiles, ArgsAdjuster, NumJobs, Cache.get(), PreambleIsBuilt ? &Preamble : NULL, Result);
+				}
+
+				if(Cache){
+					Cache->PrintSummary();
+				}
+				if(PreambleIsBuilt){
+					Preamble.PrintSummary();
+				}
+
+				std::string FragmentFile = EmitFragment.empty() ? "fragment-" + std::to_string(ShardIdx) + "-of-" + std::to_string(NumShards) + ".pint" : EmitFragment.getValue();
+				try{
+					TimeReport::Phase Phase("Emit fragment");
+					Result.Emit(FragmentFile, ShardIdx, NumShards, analyseList.size());
+				}
+				catch(ResultFragmentException& e){
+					std::cout << e.what();
+					return 1;
+				}
+
+				std::cout << "Shard " << ShardIdx << "/" << NumShards << ": " << ShardFiles.size() << " of " << analyseList.size() << " files written to " << FragmentFile << '\n';
+				return retcode;
+			}
+			else if(NumJobs == 1 && CacheDir.empty() && !PreambleIsBuilt){
+				TimeReport::Phase Phase("Analysis");
+				HPCPatternInstrActionFactory Factory(&Session);
+				retcode = HPCPatternTool.run(&Factory);
+			}
+			else if(CacheDir.empty()){
+				TimeReport::Phase Phase("Analysis");
+				retcode = RunParallelAnalysis(&Session, OptsParser.getCompilations(), analyseList, ArgsAdjuster, NumJobs, NULL, PreambleIsBuilt ? &Preamble : NULL);
+			}
+			else{
+				TimeReport::Phase Phase("Analysis");
+				AnalysisCache Cache(CacheDir.getValue(), OptsParser.getCompilations(), ArgsAdjuster);
+				retcode = RunParallelAnalysis(&Session, OptsParser.getCompilations(), analyseList, ArgsAdjuster, NumJobs, &Cache, PreambleIsBuilt ? &Preamble : NULL);
+				Cache.PrintSummary();
+			}
+
+			if(PreambleIsBuilt){
+				Preamble.PrintSummary();
+			}
 		}
 		catch(std::exception& terminate){
 			std::cout << terminate.what();
       return 0;
 		}
-    try{
-      ClTre->lookIfTreeIsCorrect();
-    }
-    catch(TooManyBeginsException& begins){
-      begins.what();
-      return 0;
-    }
-		//int halstead = HPCPatternTool.run(clang::tooling::newFrontendActionFactory<HalsteadClassAction>().get());
-	  if(!NoTree.getValue()){
-			int mxdspldpth = MaxTreeDisplayDepth.getValue();
-      if(RelationTree.getValue())
-      {
-		    CallTreeVisualisation::PrintRelationTree(mxdspldpth, OnlyPatterns.getValue());
-        CallTreeVisualisation::PrintCallTree(mxdspldpth, ClTre, OnlyPatterns.getValue());
-      }
-      else
-        CallTreeVisualisation::PrintCallTree(mxdspldpth, ClTre, OnlyPatterns.getValue());
-	  }
-
-		for (HPCPatternStatistic* Stat : Statistics)
-		{
-			std::cout << std::endl << std::endl;
-			Stat->Calculate();
-			Stat->Print();
-		}
-
-		Statistics[0]->CSVExport("Counts.csv");
-		Statistics[1]->CSVExport("FIFO.csv");
-		Statistics[2]->CSVExport("LOC.csv");
-
 
-		/* Similarity Measures
-		std::vector<HPCParallelPattern*> SimPatterns;
-
-		HPCParallelPattern* IMVI = PatternGraph::GetInstance()->GetPattern(DesignSpace::ImplementationMechanism, "VariableIncrement");
-		HPCParallelPattern* FCGT = PatternGraph::GetInstance()->GetPattern(DesignSpace::FindingConcurrency, "GroupTask");
-		HPCParallelPattern* IMCO = PatternGraph::GetInstance()->GetPattern(DesignSpace::ImplementationMechanism, "Communication");
-		HPCParallelPattern* IMSY = PatternGraph::GetInstance()->GetPattern(DesignSpace::ImplementationMechanism, "Synchronization");
-
-		SimPatterns.push_back(IMCO);
-		SimPatterns.push_back(IMSY);
-
-		JaccardSimilarityStatistic Jaccard(SimPatterns, 2, 4, GraphSearchDirection::DIR_Parents, SimilarityCriterion::Pattern, 1000);
-
-		Jaccard.Calculate();
-		Jaccard.Print();
-	*/
-		return retcode; //&& halstead;
+		return FinishAnalysis(&Session, retcode);
 	}
 	return 1;
 }
@@ -1,7 +1,5 @@
 #include "HPCRunningStats.h"
 
-Halstead* actualHal;
-
 /*CommandLine arguments */
 bool* notree;
 bool* relationtree;
@@ -12,14 +10,6 @@ bool* displaycompilatonslist;
 bool* printversion;
 
 
-void setActualHalstead(Halstead* actualHalstead){
-    actualHal = actualHalstead;
-}
-
-Halstead* getActualHalstead(){
-    return actualHal;
-}
-
 void setRelationTree(bool value){
   relationtree = &value;
 }
@@ -1,10 +1,5 @@
 #pragma once
 
-class Halstead;
-
-  void setActualHalstead(Halstead* actualHalstead);
-  Halstead* getActualHalstead();
-
   void setCommandArguments(bool onlyPattern, bool noTree, bool useSpecFiles, bool maxTreeDisplayDepth, bool displayCompilationsList, bool printVersion, bool relationTree);
   bool* getonlypattern();
   bool* getnotree();
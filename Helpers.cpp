@@ -1,4 +1,5 @@
 #include "Helpers.h"
+#include "FrozenPatternGraph.h"
 #include <vector>
 
 
@@ -11,7 +12,7 @@
  *
  * @return A list of PatternOccurrence objects, free from duplicates iff flag is set.
  **/
-std::vector<PatternOccurrence*> PatternHelpers::GetPatternOccurrences(std::vector<PatternCodeRegion*> CodeRegions, bool MakeUnique)
+std::vector<PatternOccurrence*> PatternHelpers::GetPatternOccurrences(llvm::ArrayRef<PatternCodeRegion*> CodeRegions, bool MakeUnique)
 {
 	/* Retrieve all pattern occurrences from the code regions */
 	std::vector<PatternOccurrence*> PatternOccurrences;
@@ -32,44 +33,63 @@ std::vector<PatternOccurrence*> PatternHelpers::GetPatternOccurrences(std::vecto
 
 /**
  * @brief A tree operation that marks every tree node with the label corresponding to its connected component.
- * Calls GraphAlgorithms::MarkConnectedComponents(PatternGraphNode*, int).
+ * Calls GraphAlgorithms::MarkConnectedComponents(PatternGraph*, PatternGraphNode*, int).
+ *
+ * @param Graph The graph whose nodes are marked.
  */
-void GraphAlgorithms::MarkConnectedComponents()
+void GraphAlgorithms::MarkConnectedComponents(PatternGraph* Graph)
 {
-	std::vector<PatternCodeRegion*> PatternCodeRegs = PatternGraph::GetInstance()->GetAllPatternCodeRegions();
+	const FrozenPatternGraph* Frozen = Graph->GetFrozenGraph();
 
 	int ConnectedComponents = 0;
 
-	for (PatternCodeRegion* PatternCodeReg : PatternCodeRegs)
+	/* The code regions have the lowest IDs, in the order of PatternGraph::GetAllPatternCodeRegions() */
+	for (FrozenPatternGraph::NodeID ID = 0; ID < Frozen->GetNumNodes() && Frozen->IsCodeRegion(ID); ID++)
 	{
-		if (PatternCodeReg->GetConnectedComponent() == -1)
+		if (Frozen->GetNode(ID)->GetConnectedComponent() == -1)
 		{
-			MarkConnectedComponents(PatternCodeReg, ConnectedComponents);
+			MarkConnectedComponents(Graph, Frozen->GetNode(ID), ConnectedComponents);
 			ConnectedComponents++;
 		}
 	}
 }
 
 /**
- * @brief Marks every tree node with label corresponding to connected component
+ * @brief Marks every tree node with label corresponding to connected component.
+ * The nodes are visited with an explicit stack on the FrozenPatternGraph.
  *
+ * @param Graph The graph of the node.
  * @param Node The current node.
  * @param ComponentID ID of the connected component.
  **/
-void GraphAlgorithms::MarkConnectedComponents(PatternGraphNode* Node, int ComponentID)
+void GraphAlgorithms::MarkConnectedComponents(PatternGraph* Graph, PatternGraphNode* Node, int ComponentID)
 {
-	if (Node->GetConnectedComponent() == -1)
+	if (Node->GetConnectedComponent() != -1)
 	{
-		Node->SetConnectedComponent(ComponentID);
+		return;
+	}
 
-		for (PatternGraphNode* Child : Node->GetChildren())
-		{
-			MarkConnectedComponents(Child, ComponentID);
-		}
+	const FrozenPatternGraph* Frozen = Graph->GetFrozenGraph();
+
+	std::vector<FrozenPatternGraph::NodeID> Stack;
+	Stack.push_back(Frozen->GetNodeID(Node));
+	Node->SetConnectedComponent(ComponentID);
+
+	while (!Stack.empty())
+	{
+		FrozenPatternGraph::NodeID Current = Stack.back();
+		Stack.pop_back();
 
-		for (PatternGraphNode* Parent : Node->GetParents())
+		for (llvm::ArrayRef<FrozenPatternGraph::NodeID> Neighbours : { Frozen->GetChildren(Current), Frozen->GetParents(Current) })
 		{
-			MarkConnectedComponents(Parent, ComponentID);
+			for (FrozenPatternGraph::NodeID Neighbour : Neighbours)
+			{
+				if (Frozen->GetNode(Neighbour)->GetConnectedComponent() == -1)
+				{
+					Frozen->GetNode(Neighbour)->SetConnectedComponent(ComponentID);
+					Stack.push_back(Neighbour);
+				}
+			}
 		}
 	}
 }
@@ -78,25 +98,26 @@ void GraphAlgorithms::MarkConnectedComponents(PatternGraphNode* Node, int Compon
  * @brief Finds the parent patterns, beginning from a PatternCodeRegion.
  * Saves the parent patterns in the list of PatternOccurrence passed as second parameter.
  *
+ * @param Graph The graph of the code region.
  * @param Start Initial PatternCodeRegion from which the search is started.
  * @param Parents Reference to a std::vector of PatternOccurrence* in which the encountered occurrences are saved.
  * @param maxdepth Maximum depth of the recursion.
  **/
-void GraphAlgorithms::FindParentPatternCodeRegions(PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Parents, int maxdepth)
+void GraphAlgorithms::FindParentPatternCodeRegions(PatternGraph* Graph, PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Parents, int maxdepth)
 {
 	int a = 0;
 	int* p = &a;
-	FindNeighbourPatternCodeRegionss(Start, Parents, DIR_Parents, p, maxdepth);
+	FindNeighbourPatternCodeRegionss(Graph, Start, Parents, DIR_Parents, p, maxdepth);
 }
 
 /**
  * @brief Finds the child patterns from a starting point. See GraphAlgorithms::FindParentPatternCodeRegions().
  **/
-void GraphAlgorithms::FindChildPatternCodeRegions(PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Children, int maxdepth)
+void GraphAlgorithms::FindChildPatternCodeRegions(PatternGraph* Graph, PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Children, int maxdepth)
 {
 	int a = 0;
 	int* p = &a;
-	FindNeighbourPatternCodeRegionss(Start, Children, DIR_Children, p, maxdepth);
+	FindNeighbourPatternCodeRegionss(Graph, Start, Children, DIR_Children, p, maxdepth);
 }
 
 /**
@@ -126,7 +147,7 @@ void GraphAlgorithms::FindNeighbourPatternCodeRegions(PatternGraphNode* Current,
 	else
 	{
 		/* Get the neighbouring nodes depending on the defined search direction */
-		std::vector<PatternGraphNode*> Neighbours;
+		llvm::ArrayRef<PatternGraphNode*> Neighbours;
 
 		if (dir == DIR_Parents)
 		{
@@ -150,7 +171,11 @@ void GraphAlgorithms::FindNeighbourPatternCodeRegions(PatternGraphNode* Current,
 		return;
 }
 
-void GraphAlgorithms::FindNeighbourPatternCodeRegionss(PatternGraphNode* Current, std::vector<PatternCodeRegion*>& Results, GraphSearchDirection dir, int* depth, int maxdepth)
+/**
+ * @brief Same as GraphAlgorithms::FindNeighbourPatternCodeRegions(), but the depth is shared between all branches of the descent.
+ * The search runs on the FrozenPatternGraph.
+ **/
+static void VisitNeighbourPatternCodeRegions(const FrozenPatternGraph* Graph, FrozenPatternGraph::NodeID Current, std::vector<PatternCodeRegion*>& Results, GraphSearchDirection dir, int* depth, int maxdepth)
 {
 	/* Check, if we reached the maximum depth */
 	if (*depth >= maxdepth)
@@ -158,38 +183,37 @@ void GraphAlgorithms::FindNeighbourPatternCodeRegionss(PatternGraphNode* Current
 		return;
 	}
 
-	PatternCodeRegion* PatternReg = clang::dyn_cast<PatternCodeRegion>(Current);
-
-	if (*depth > 0 && PatternReg != NULL)
+	if (*depth > 0 && Graph->IsCodeRegion(Current))
 	{
-		Results.push_back(PatternReg);
+		Results.push_back(Graph->GetCodeRegion(Current));
 	}
 	else
 	{
 		/* Get the neighbouring nodes depending on the defined search direction */
-		std::vector<PatternGraphNode*> Neighbours;
+		llvm::ArrayRef<FrozenPatternGraph::NodeID> Neighbours;
 
 		if (dir == DIR_Parents)
 		{
-			Neighbours = Current->GetParents();
+			Neighbours = Graph->GetParents(Current);
 		}
 		else if (dir == DIR_Children)
 		{
-			Neighbours = Current->GetChildren();
+			Neighbours = Graph->GetChildren(Current);
 		}
 
-
-
 		/* Visit all the neighbouring nodes according to the given direction */
-		if (Neighbours.size() > 0 && Neighbours[0] != NULL && Neighbours[0] != 0){
-			for (PatternGraphNode* Neighbour : Neighbours)
-			{
-				*depth = *depth + 1;
-				FindNeighbourPatternCodeRegionss(Neighbour, Results, dir, depth , maxdepth);
-			}
+		for (FrozenPatternGraph::NodeID Neighbour : Neighbours)
+		{
+			*depth = *depth + 1;
+			VisitNeighbourPatternCodeRegions(Graph, Neighbour, Results, dir, depth, maxdepth);
 		}
 	}
-		return;
+}
+
+void GraphAlgorithms::FindNeighbourPatternCodeRegionss(PatternGraph* Graph, PatternGraphNode* Current, std::vector<PatternCodeRegion*>& Results, GraphSearchDirection dir, int* depth, int maxdepth)
+{
+	const FrozenPatternGraph* Frozen = Graph->GetFrozenGraph();
+	VisitNeighbourPatternCodeRegions(Frozen, Frozen->GetNodeID(Current), Results, dir, depth, maxdepth);
 }
 
 /**
@@ -14,21 +14,21 @@ enum GraphSearchDirection
 
 namespace PatternHelpers
 {
-	extern std::vector<PatternOccurrence*> GetPatternOccurrences(std::vector<PatternCodeRegion*> CodeRegions, bool MakeUnique);
+	extern std::vector<PatternOccurrence*> GetPatternOccurrences(llvm::ArrayRef<PatternCodeRegion*> CodeRegions, bool MakeUnique);
 }
 
 namespace GraphAlgorithms
 {
-	extern void MarkConnectedComponents();
+	extern void MarkConnectedComponents(PatternGraph* Graph);
 
-	extern void MarkConnectedComponents(PatternGraphNode* Node, int ComponentID);
+	extern void MarkConnectedComponents(PatternGraph* Graph, PatternGraphNode* Node, int ComponentID);
 
-	extern void FindParentPatternCodeRegions(PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Parents, int maxdepth);
+	extern void FindParentPatternCodeRegions(PatternGraph* Graph, PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Parents, int maxdepth);
 
-	extern void FindChildPatternCodeRegions(PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Children, int maxdepth);
+	extern void FindChildPatternCodeRegions(PatternGraph* Graph, PatternCodeRegion* Start, std::vector<PatternCodeRegion*>& Children, int maxdepth);
 
 	extern void FindNeighbourPatternCodeRegions(PatternGraphNode* Current, std::vector<PatternCodeRegion*>& Results, GraphSearchDirection dir, int depth, int maxdepth);
-	extern void FindNeighbourPatternCodeRegionss(PatternGraphNode* Current, std::vector<PatternCodeRegion*>& Results, GraphSearchDirection dir, int * depth, int maxdepth);
+	extern void FindNeighbourPatternCodeRegionss(PatternGraph* Graph, PatternGraphNode* Current, std::vector<PatternCodeRegion*>& Results, GraphSearchDirection dir, int * depth, int maxdepth);
 }
 
 namespace SetAlgorithms
@@ -0,0 +1,193 @@
+#include "ParallelAnalysis.h"
+#include "HPCPatternInstrASTTraversal.h"
+#include "TranslationUnitLog.h"
+#include "AnalysisResult.h"
+#include "AnalysisCache.h"
+#include "SharedPreamble.h"
+#include "TimeReport.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "clang/Tooling/Tooling.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+
+
+int CollectAnalysisResult(const clang::tooling::CompilationDatabase& Compilations, const std::vector<std::string>& Files, const std::vector<uint32_t>& FileIndices, clang::tooling::ArgumentsAdjuster ArgsAdjuster, unsigned int NumThreads, AnalysisCache* Cache, SharedPreamble* Preamble, AnalysisResult& Result)
+{
+	if (NumThreads > FileIndices.size())
+	{
+		NumThreads = FileIndices.size();
+	}
+
+	if (NumThreads == 0)
+	{
+		NumThreads = 1;
+	}
+
+	/* One fragment per worker, so the workers never write to the same container */
+	std::vector<AnalysisResult> Results(NumThreads);
+	std::vector<int> RetCodes(FileIndices.size(), 0);
+	std::atomic<size_t> NextFile(0);
+
+	/* The workers must not change the working directory of the process, so we have to restore it ourselves */
+	llvm::SmallString<256> InitialWorkingDir;
+	llvm::sys::fs::current_path(InitialWorkingDir);
+
+	/* Each tool gets its own file system object, which keeps the working directory of the compile command */
+	auto RunTool = [&](const std::string& File, clang::tooling::FrontendActionFactory* Factory, bool UsePreamble)
+	{
+		clang::tooling::ClangTool Tool(Compilations, { File }, std::make_shared<clang::PCHContainerOperations>(), llvm::vfs::createPhysicalFileSystem().release());
+		Tool.appendArgumentsAdjuster(ArgsAdjuster);
+		if (UsePreamble)
+		{
+			Tool.appendArgumentsAdjuster(Preamble->GetArgumentsAdjuster());
+		}
+		Tool.setRestoreWorkingDir(false);
+
+		return Tool.run(Factory);
+	};
+
+	auto Worker = [&](AnalysisResult& WorkerResult)
+	{
+		size_t Task;
+
+		while ((Task = NextFile++) < FileIndices.size())
+		{
+			uint32_t FileIdx = FileIndices[Task];
+			std::vector<TranslationUnitLog> FileLogs;
+
+			if (Cache != NULL && Cache->Load(Files[FileIdx], FileLogs))
+			{
+				WorkerResult.AddFile(FileIdx, std::move(FileLogs));
+				continue;
+			}
+
+			bool UsePreamble = Preamble != NULL;
+
+			while (true)
+			{
+				TranslationUnitLog::SetThreadSink(&FileLogs);
+				RetCodes[Task] = RunTool(Files[FileIdx], clang::tooling::newFrontendActionFactory<HPCPatternInstrAction>().get(), UsePreamble);
+				TranslationUnitLog::SetThreadSink(NULL);
+
+				/* Clang rejects the precompiled header e.g. if the compile options of the file differ, then the file is parsed again without it.
+				   Other errors are reported only once, and the file still counts as parsed with the precompiled header. */
+				if (UsePreamble && RetCodes[Task] != 0 && SharedPreamble::WasRejected())
+				{
+					FileLogs.clear();
+					UsePreamble = false;
+					continue;
+				}
+
+				break;
+			}
+
+			if (Preamble != NULL)
+			{
+				Preamble->CountTranslationUnit(UsePreamble);
+			}
+
+			/* The file is parsed again under the same conditions, only without skipping function bodies */
+			if (RetCodes[Task] == 0 && HPCPatternInstrAction::NeedsParseBaseline())
+			{
+				RunTool(Files[FileIdx], clang::tooling::newFrontendActionFactory<ParseBaselineAction>().get(), UsePreamble);
+			}
+
+			/* The headers in the precompiled header are not loaded by the source manager of the file, but the file depends on them */
+			if (UsePreamble)
+			{
+				for (TranslationUnitLog& Log : FileLogs)
+				{
+					for (const std::string& Dependency : Preamble->GetDependencies())
+					{
+						Log.AddDependency(Dependency);
+					}
+				}
+			}
+
+			/* Files with errors are parsed again in the next run, so the errors are reported again */
+			if (Cache != NULL && RetCodes[Task] == 0)
+			{
+				Cache->Store(Files[FileIdx], FileLogs);
+			}
+
+			WorkerResult.AddFile(FileIdx, std::move(FileLogs));
+		}
+	};
+
+	{
+		TimeReport::Phase Phase("Parsing and traversal");
+		std::vector<std::thread> Workers;
+
+		for (unsigned int i = 0; i < NumThreads; i++)
+		{
+			Workers.push_back(std::thread(Worker, std::ref(Results[i])));
+		}
+
+		for (std::thread& Thread : Workers)
+		{
+			Thread.join();
+		}
+	}
+
+	if (!InitialWorkingDir.empty())
+	{
+		llvm::sys::fs::set_current_path(InitialWorkingDir);
+	}
+
+	/* Reduce the fragments of the workers pairwise, the merged result contains the files in the order of the file list */
+	for (size_t Step = 1; Step < Results.size(); Step *= 2)
+	{
+		for (size_t i = 0; i + Step < Results.size(); i += 2 * Step)
+		{
+			Results[i].Merge(std::move(Results[i + Step]));
+		}
+	}
+
+	Result.Merge(std::move(Results[0]));
+
+	bool ProcessingFailed = false;
+	bool FileSkipped = false;
+
+	for (int RetCode : RetCodes)
+	{
+		if (RetCode == 1)
+		{
+			ProcessingFailed = true;
+		}
+		else if (RetCode == 2)
+		{
+			FileSkipped = true;
+		}
+	}
+
+	if (ProcessingFailed)
+	{
+		return 1;
+	}
+
+	return FileSkipped ? 2 : 0;
+}
+
+int RunParallelAnalysis(AnalysisSession* Session, const clang::tooling::CompilationDatabase& Compilations, const std::vector<std::string>& Files, clang::tooling::ArgumentsAdjuster ArgsAdjuster, unsigned int NumThreads, AnalysisCache* Cache, SharedPreamble* Preamble)
+{
+	std::vector<uint32_t> FileIndices;
+	for (uint32_t FileIdx = 0; FileIdx < Files.size(); FileIdx++)
+	{
+		FileIndices.push_back(FileIdx);
+	}
+
+	AnalysisResult Result;
+	int RetCode = CollectAnalysisResult(Compilations, Files, FileIndices, ArgsAdjuster, NumThreads, Cache, Preamble, Result);
+
+	/* Build the PatternGraph and the CallTree in the same order as a serial run would */
+	TimeReport::Phase Phase("Replay");
+	Result.Replay(Session);
+
+	return RetCode;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+
+class AnalysisCache;
+class SharedPreamble;
+class AnalysisSession;
+class AnalysisResult;
+
+
+
+/**
+ * @brief Runs the HPCPatternInstrAction on the given files with a pool of worker threads.
+ * Every worker parses and traverses whole translation units and records the extracted facts in a TranslationUnitLog.
+ * The session is not touched by the workers, each worker collects the logs of its files in an AnalysisResult.
+ * After all workers are finished, their results are merged and replayed into the session in the order of the file list.
+ * Therefore the result is identical to the result of a serial run of the ClangTool.
+ * If a cache is given, files with a valid cache entry are not parsed and the cache is updated for all other files.
+ * If a preamble is given, the files are parsed with its precompiled header. Files for which this fails are parsed again without it.
+ *
+ * @param Session The session the results are added to.
+ * @param Compilations The compilation database.
+ * @param Files The source files to analyse.
+ * @param ArgsAdjuster The arguments adjuster appended to the tool of each file.
+ * @param NumThreads The number of worker threads.
+ * @param Cache The cache for the logs of the files or NULL.
+ * @param Preamble The built precompiled header of the common headers or NULL.
+ *
+ * @return 0 on success, 1 if any error occurred, 2 if there is no error but some files are skipped, like the return code of ClangTool::run().
+ **/
+int RunParallelAnalysis(AnalysisSession* Session, const clang::tooling::CompilationDatabase& Compilations, const std::vector<std::string>& Files, clang::tooling::ArgumentsAdjuster ArgsAdjuster, unsigned int NumThreads, AnalysisCache* Cache, SharedPreamble* Preamble = NULL);
+
+/**
+ * @brief Analyses a subset of the given files like RunParallelAnalysis(), but collects the logs in an AnalysisResult instead of replaying them.
+ * The files are identified by their positions in the complete file list, so the results of different subsets can be merged later (see AnalysisResult::Merge()).
+ *
+ * @param Compilations The compilation database.
+ * @param Files The complete list of source files.
+ * @param FileIndices The positions of the files to analyse in the file list.
+ * @param ArgsAdjuster The arguments adjuster appended to the tool of each file.
+ * @param NumThreads The number of worker threads.
+ * @param Cache The cache for the logs of the files or NULL.
+ * @param Preamble The built precompiled header of the common headers or NULL.
+ * @param Result The fragment the logs of the files are merged into.
+ *
+ * @return 0 on success, 1 if any error occurred, 2 if there is no error but some files are skipped, like the return code of ClangTool::run().
+ **/
+int CollectAnalysisResult(const clang::tooling::CompilationDatabase& Compilations, const std::vector<std::string>& Files, const std::vector<uint32_t>& FileIndices, clang::tooling::ArgumentsAdjuster ArgsAdjuster, unsigned int NumThreads, AnalysisCache* Cache, SharedPreamble* Preamble, AnalysisResult& Result);
@@ -1,9 +1,15 @@
 #include "PatternGraph.h"
 
 #include "HPCParallelPattern.h"
+#include "FrozenPatternGraph.h"
+#include "TimeReport.h"
 
 #include <iostream>
+#include <algorithm>
 #include "clang/AST/ODRHash.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/xxhash.h"
 #include "HPCError.h"
 
 #define SUITEDFORSTATSDEBUG
@@ -13,10 +19,11 @@
 /*
  * Function Declaration Database Entry functions
  */
-FunctionNode::FunctionNode (std::string Name, unsigned Hash) : PatternGraphNode(GNK_FnCall), Children(), Parents()
+FunctionNode::FunctionNode (std::string Name, uint64_t Hash, Atom USR) : PatternGraphNode(GNK_FnCall), Children(), Parents()
 {
-	this->FnName = Name;
+	this->FnName = AtomTable::Intern(Name);
 	this->Hash = Hash;
+	this->USR = USR;
 }
 
 void FunctionNode::AddChild(PatternGraphNode* Child)
@@ -34,12 +41,12 @@ void FunctionNode::AddPatternParent(PatternGraphNode* PatParent)
 	*/
 	PatternCodeRegion* PatternParent = clang::dyn_cast<PatternCodeRegion>(PatParent);
 	for(PatternCodeRegion* PatRegFor : this->PatternParents){
-		if(PatRegFor->GetID() == PatternParent->GetID()) return;
+		if(PatRegFor->GetIDAtom() == PatternParent->GetIDAtom()) return;
 	}
 	this->PatternParents.push_back(PatternParent);
 }
 
-void FunctionNode::AddPatternParents(std::vector<PatternCodeRegion*> PatternParents){
+void FunctionNode::AddPatternParents(llvm::ArrayRef<PatternCodeRegion*> PatternParents){
 	for(PatternCodeRegion* PatParent : PatternParents){
 		this->AddPatternParent(PatParent);
 	}
@@ -50,21 +57,11 @@ void FunctionNode::AddPatternChild(PatternGraphNode* PatChild)
 	*/
 	PatternCodeRegion* PatternChild = clang::dyn_cast<PatternCodeRegion>(PatChild);
 	for(PatternCodeRegion* PatRegFor : this->PatternChildren){
-		if(PatRegFor->GetID() == PatternChild->GetID()) return;
+		if(PatRegFor->GetIDAtom() == PatternChild->GetIDAtom()) return;
 	}
 	this->PatternChildren.push_back(PatternChild);
 }
 
-std::vector<PatternCodeRegion*> FunctionNode::GetPatternParents()
-{
-	return this->PatternParents;
-}
-
-std::vector<PatternCodeRegion*> FunctionNode::GetPatternChildren()
-{
-	return this->PatternChildren;
-}
-
 bool FunctionNode::HasNoPatternParents(){
 	if(this->PatternParents.size()){
 		return false;
@@ -99,7 +96,7 @@ void FunctionNode::registerPatChildrenToPatParents(){
 	}
 }
 
-void FunctionNode::PrintVecOfPattern(std::vector<PatternCodeRegion*> RegionVec)
+void FunctionNode::PrintVecOfPattern(llvm::ArrayRef<PatternCodeRegion*> RegionVec)
 {
 		for(PatternCodeRegion* PatReg : RegionVec)
 		{
@@ -114,6 +111,91 @@ PatternGraph::PatternGraph() : Functions(), Patterns(), PatternOccurrences()
 
 }
 
+PatternGraph::~PatternGraph()
+{
+}
+
+HPCParallelPattern* PatternGraph::CreatePattern(DesignSpace DesignSp, Atom PatternName)
+{
+	return new (PatternAllocator.Allocate()) HPCParallelPattern(DesignSp, PatternName);
+}
+
+PatternOccurrence* PatternGraph::CreatePatternOccurrence(HPCParallelPattern* Pattern, Atom ID)
+{
+	return new (PatternOccurrenceAllocator.Allocate()) PatternOccurrence(Pattern, ID);
+}
+
+PatternCodeRegion* PatternGraph::CreatePatternCodeRegion(PatternOccurrence* PatternOcc)
+{
+	return new (CodeRegionAllocator.Allocate()) PatternCodeRegion(PatternOcc);
+}
+
+FunctionNode* PatternGraph::CreateFunctionNode(std::string Name, uint64_t Hash, Atom USR)
+{
+	return new (FunctionAllocator.Allocate()) FunctionNode(Name, Hash, USR);
+}
+
+CallTreeNode* PatternGraph::CreateCallTreeNode(CallTreeNodeType NodeType, PatternCodeRegion* CorrespondingPat)
+{
+	TimeReport::Count(TRC_CallTreeNodes);
+	return new (CallTreeNodeAllocator.Allocate()) CallTreeNode(NodeType, CorrespondingPat);
+}
+
+CallTreeNode* PatternGraph::CreateCallTreeNode(CallTreeNodeType NodeType, FunctionNode* CorrespondingFunction)
+{
+	TimeReport::Count(TRC_CallTreeNodes);
+	return new (CallTreeNodeAllocator.Allocate()) CallTreeNode(NodeType, CorrespondingFunction);
+}
+
+CallTreeNode* PatternGraph::CreateCallTreeNode(CallTreeNodeType NodeType, std::string Identification)
+{
+	TimeReport::Count(TRC_CallTreeNodes);
+	return new (CallTreeNodeAllocator.Allocate()) CallTreeNode(NodeType, Identification);
+}
+
+CallTreeNode* PatternGraph::CreateCallTreeNode(CallTreeNodeType NodeType, Identification Ident)
+{
+	TimeReport::Count(TRC_CallTreeNodes);
+	return new (CallTreeNodeAllocator.Allocate()) CallTreeNode(NodeType, Ident);
+}
+
+void PatternGraph::Freeze()
+{
+	Frozen.reset(new FrozenPatternGraph(this));
+}
+
+const FrozenPatternGraph* PatternGraph::GetFrozenGraph()
+{
+	if (!Frozen)
+	{
+		Freeze();
+	}
+
+	return Frozen.get();
+}
+
+void PatternGraph::Reset()
+{
+	Patterns.clear();
+	PatternOccurrences.clear();
+	Functions.clear();
+
+	PatternIndex.clear();
+	PatternOccurrenceIndex.clear();
+	FunctionIndex.clear();
+
+	RootNode = NULL;
+	OnlyPatternRootNodes.clear();
+	Frozen.reset();
+
+	/* The call tree nodes reference the graph nodes, so they are released first */
+	CallTreeNodeAllocator.DestroyAll();
+	CodeRegionAllocator.DestroyAll();
+	FunctionAllocator.DestroyAll();
+	PatternOccurrenceAllocator.DestroyAll();
+	PatternAllocator.DestroyAll();
+}
+
 
 PatternGraphNode* PatternGraph::GetRootNode()
 {
@@ -126,30 +208,54 @@ PatternGraphNode* PatternGraph::GetRootNode()
 	return (PatternGraphNode*)Patterns.front();
 }
 
-std::vector<PatternGraphNode*> PatternGraph::GetOnlyPatternRootNodes(){
-		return this->OnlyPatternRootNodes;
+std::string PatternGraph::GetFunctionUSR(clang::FunctionDecl* Decl)
+{
+	llvm::SmallString<128> USR;
+
+	/* generateUSRForDecl returns true if no USR can be generated for the declaration */
+	if (clang::index::generateUSRForDecl(Decl, USR))
+	{
+		clang::ODRHash Hash;
+		Hash.AddDecl(Decl);
+		return "odr@" + std::to_string(Hash.CalculateHash());
+	}
+
+	return USR.str().str();
+}
+
+uint64_t PatternGraph::CalculateFunctionHash(llvm::StringRef USR)
+{
+	return llvm::xxHash64(USR);
 }
 
 FunctionNode* PatternGraph::GetFunctionNode(clang::FunctionDecl* Decl)
 {
-	clang::ODRHash Hash;
-	Hash.AddDecl(Decl);
-	unsigned HashVal = Hash.CalculateHash();
+	return GetFunctionNode(CalculateFunctionHash(GetFunctionUSR(Decl)));
+}
 
-	std::string FnName = Decl->getNameInfo().getName().getAsString();
+FunctionNode* PatternGraph::GetFunctionNode(uint64_t Hash)
+{
+	auto Entry = FunctionIndex.find(Hash);
 
-	// Search for an existing entry
-	for (FunctionNode* Func : Functions)
+	if (Entry != FunctionIndex.end())
 	{
-		if (Func->GetHash() == HashVal)
-		{
-			return Func;
-		}
+		return Entry->second;
 	}
 
 	return NULL;
 }
 
+FunctionNode* PatternGraph::GetFunctionNode(uint64_t Hash, Atom USR)
+{
+	FunctionNode* Func = GetFunctionNode(Hash);
+
+	if (Func != NULL && Func->GetUSRAtom() != USR)
+	{
+		throw FunctionHashCollisionException(AtomTable::GetString(Func->GetUSRAtom()).str(), AtomTable::GetString(USR).str());
+	}
+
+	return Func;
+}
 
 	void PatternGraph::RegisterOnlyPatternRootNode(PatternCodeRegion* CodeReg)
 	{
@@ -158,45 +264,52 @@ FunctionNode* PatternGraph::GetFunctionNode(clang::FunctionDecl* Decl)
 
 bool PatternGraph::RegisterFunction(clang::FunctionDecl* Decl)
 {
-	if (GetFunctionNode(Decl) != NULL)
-	{
-		return false;
-	}
-
 	/* Extract information from the clang object */
-	clang::ODRHash Hash;
-	Hash.AddDecl(Decl);
-	unsigned HashVal = Hash.CalculateHash();
-
 	std::string FnName = Decl->getNameInfo().getName().getAsString();
 
+	std::string USR = GetFunctionUSR(Decl);
+
+	return RegisterFunction(FnName, CalculateFunctionHash(USR), AtomTable::Intern(USR), Decl->isMain());
+}
+
+bool PatternGraph::RegisterFunction(std::string Name, uint64_t Hash, Atom USR, bool IsMain)
+{
+	if (GetFunctionNode(Hash) != NULL)
+	{
+		return false;
+	}
 
 	/* Allocate a new entry */
 	FunctionNode* Func;
-	Func = new FunctionNode(FnName, HashVal);
+	Func = CreateFunctionNode(Name, Hash, USR);
 	Functions.push_back(Func);
+	FunctionIndex[Hash] = Func;
+	TimeReport::Count(TRC_RegisteredFunctions);
 
 
 	/* Set as root node if this is the main function */
 	/* Do the same thing for the callTree*/
-	if (Decl->isMain())
+	if (IsMain)
 	{
 		this->RootNode = Func;
 	}
 
-	return Func;
+	return true;
 }
 
 
 HPCParallelPattern* PatternGraph::GetPattern(DesignSpace DesignSp, std::string PatternName)
 {
-	/* Go through the list of parallel patterns to find the parallel pattern with the given identifier */
-	for (HPCParallelPattern* Pattern : Patterns)
+	return GetPattern(DesignSp, AtomTable::Intern(PatternName));
+}
+
+HPCParallelPattern* PatternGraph::GetPattern(DesignSpace DesignSp, Atom PatternName)
+{
+	auto Entry = PatternIndex.find(std::make_pair((unsigned)DesignSp, PatternName));
+
+	if (Entry != PatternIndex.end())
 	{
-		if (DesignSp == Pattern->GetDesignSpace() && !PatternName.compare(Pattern->GetPatternName()))
-		{
-			return Pattern;
-		}
+		return Entry->second;
 	}
 
 	return NULL;
@@ -204,23 +317,28 @@ HPCParallelPattern* PatternGraph::GetPattern(DesignSpace DesignSp, std::string P
 
 bool PatternGraph::RegisterPattern(HPCParallelPattern* Pattern)
 {
-	if (GetPattern(Pattern->GetDesignSpace(), Pattern->GetPatternName()) != NULL)
+	if (GetPattern(Pattern->GetDesignSpace(), Pattern->GetPatternNameAtom()) != NULL)
 	{
 		return false;
 	}
 
 	Patterns.push_back(Pattern);
+	PatternIndex[std::make_pair((unsigned)Pattern->GetDesignSpace(), Pattern->GetPatternNameAtom())] = Pattern;
 	return true;
 }
 
 PatternOccurrence* PatternGraph::GetPatternOccurrence(std::string ID)
 {
-	for (PatternOccurrence* PatternOcc : PatternOccurrences)
+	return GetPatternOccurrence(AtomTable::Intern(ID));
+}
+
+PatternOccurrence* PatternGraph::GetPatternOccurrence(Atom ID)
+{
+	auto Entry = PatternOccurrenceIndex.find(ID);
+
+	if (Entry != PatternOccurrenceIndex.end())
 	{
-		if (!ID.compare(PatternOcc->GetID()))
-		{
-			return PatternOcc;
-		}
+		return Entry->second;
 	}
 
 	return NULL;
@@ -228,37 +346,57 @@ PatternOccurrence* PatternGraph::GetPatternOccurrence(std::string ID)
 
 bool PatternGraph::RegisterPatternOccurrence(PatternOccurrence* PatternOcc)
 {
-	if (GetPatternOccurrence(PatternOcc->GetID()) != NULL)
+	if (GetPatternOccurrence(PatternOcc->GetIDAtom()) != NULL)
 	{
 		return false;
 	}
 
 	PatternOccurrences.push_back(PatternOcc);
+	PatternOccurrenceIndex[PatternOcc->GetIDAtom()] = PatternOcc;
 
 	return true;
 }
 
-std::vector<PatternCodeRegion*> PatternGraph::GetAllPatternCodeRegions()
+void PatternGraph::RebuildIndices()
 {
-	std::vector<PatternCodeRegion*> CodeRegions;
+	PatternIndex.clear();
+	PatternOccurrenceIndex.clear();
+	FunctionIndex.clear();
+
+	/* Like the linear search before, the first registered object wins */
+	for (HPCParallelPattern* Pattern : Patterns)
+	{
+		PatternIndex.insert({std::make_pair((unsigned)Pattern->GetDesignSpace(), Pattern->GetPatternNameAtom()), Pattern});
+	}
 
 	for (PatternOccurrence* PatternOcc : PatternOccurrences)
 	{
-		for (PatternCodeRegion* CodeRegion : PatternOcc->GetCodeRegions())
-		{
-			CodeRegions.push_back(CodeRegion);
-		}
+		PatternOccurrenceIndex.insert({PatternOcc->GetIDAtom(), PatternOcc});
 	}
 
-	return CodeRegions;
+	for (FunctionNode* Func : Functions)
+	{
+		FunctionIndex.insert({Func->GetHash(), Func});
+	}
 }
 
-CallTree* ClTre = new CallTree();
+CodeRegionRange PatternGraph::GetAllPatternCodeRegions()
+{
+	return CodeRegionRange(PatternOccurrences);
+}
 
-Identification::~Identification()
+PatternCodeRegion* PatternGraph::PatternIDisUsed(std::string ID)
 {
-	std::cout << "Identification of:" <<IdentificationString <<
-"or" << IdentificationUnsigned << "is deleted"<< '\n';
+	return PatternIDisUsed(AtomTable::Intern(ID));
+}
+
+PatternCodeRegion* PatternGraph::PatternIDisUsed(Atom ID)
+{
+	PatternOccurrence* PatternOcc = GetPatternOccurrence(ID);
+	if(PatternOcc == NULL || PatternOcc->GetNumberOfCodeRegions() == 0){
+		return NULL;
+	}
+	return PatternOcc->GetCodeRegions().front();
 }
 
 Identification::Identification(){
@@ -268,11 +406,11 @@ Identification::Identification(CallTreeNodeType type, std::string identification
 {
 
 	if(type == Pattern_Begin || type == Pattern_End){
-		this->IdentificationString = identification;
+		this->IdentificationAtom = AtomTable::Intern(identification);
 	}
 }
 
-Identification::Identification(CallTreeNodeType type, unsigned identification)
+Identification::Identification(CallTreeNodeType type, uint64_t identification)
 {
 	if(type == Function || type == Function_Decl || type == Root){
 		this->IdentificationUnsigned = identification;
@@ -281,23 +419,23 @@ Identification::Identification(CallTreeNodeType type, unsigned identification)
 
 bool Identification::compare(Identification* ident)
 {
-	if(ident->IdentificationString.empty()){
+	if(ident->IdentificationAtom == 0){
 		return IdentificationUnsigned == ident->IdentificationUnsigned;
 	}
-	return !IdentificationString.compare(ident->IdentificationString);
+	return IdentificationAtom == ident->IdentificationAtom;
 }
 
-bool Identification::compare(unsigned Hash)
+bool Identification::compare(uint64_t Hash)
 {
 	return IdentificationUnsigned == Hash;
 }
 
 bool Identification::compare(std::string Id)
 {
-	return !IdentificationString.compare(Id);
+	return IdentificationAtom == AtomTable::Intern(Id);
 }
 
-CallTree::CallTree()
+CallTree::CallTree(PatternGraph* Graph) : Graph(Graph)
 {
 		RootNode = NULL;
 }
@@ -305,9 +443,20 @@ CallTree::CallTree()
 CallTree::~CallTree(){
 }
 
+void CallTree::Reset()
+{
+	Pattern_EndVector.clear();
+	DeclarationVector.clear();
+	DeclsByHash.clear();
+	DeclsByID.clear();
+	CallerPaths.clear();
+	RootNode = NULL;
+}
+
 CallTreeNode* CallTree::registerNode(CallTreeNodeType NodeType, PatternCodeRegion* PatCodeReg, CallTreeNodeType LastVisited, PatternCodeRegion* TopOfStack, FunctionNode* surroundingFunc)
 {
-	CallTreeNode* Node = new CallTreeNode(NodeType, PatCodeReg);
+	CallTreeNode* Node = Graph->CreateCallTreeNode(NodeType, PatCodeReg);
+	insertNode(Node);
 	if(NodeType == Pattern_Begin || NodeType == Pattern_End)
 	{
 		if(LastVisited == Function_Decl)
@@ -346,7 +495,8 @@ CallTreeNode* CallTree::registerNode(CallTreeNodeType NodeType, PatternCodeRegio
 
 CallTreeNode* CallTree::registerNode(CallTreeNodeType NodeType, FunctionNode* FuncNode, CallTreeNodeType LastVisited, PatternCodeRegion* TopOfStack, FunctionNode* surroundingFunc)
 {
-	CallTreeNode* Node = new CallTreeNode(NodeType, FuncNode);
+	CallTreeNode* Node = Graph->CreateCallTreeNode(NodeType, FuncNode);
+	insertNode(Node);
  if(NodeType == Function){
   // warunung das hier muss später ersetzt werden so wird auch die Rekursion ausgeschlossen
 	 if(LastVisited == Function_Decl){
@@ -365,12 +515,13 @@ CallTreeNode* CallTree::registerNode(CallTreeNodeType NodeType, FunctionNode* Fu
 }
 
 CallTreeNode* CallTree::registerEndNode(CallTreeNodeType NodeType, std::string identification, CallTreeNodeType LastVisited, PatternCodeRegion* TopOfStack, FunctionNode* surroundingFunc){
-	PatternCodeRegion* CorrespReg = PatternIDisUsed(identification);
+	PatternCodeRegion* CorrespReg = Graph->PatternIDisUsed(identification);
 	CallTreeNode* Node;
 	if(CorrespReg!=NULL)
-		Node = new CallTreeNode(NodeType, CorrespReg);
+		Node = Graph->CreateCallTreeNode(NodeType, CorrespReg);
 	else
-		Node = new CallTreeNode(NodeType, identification);
+		Node = Graph->CreateCallTreeNode(NodeType, identification);
+	insertNode(Node);
 		#ifdef DEBUG
 			std::cout << "LastVisited = "<< LastVisited << '\n';
 		#endif
@@ -420,19 +571,13 @@ void CallTree::appendCallerToNode(CallTreeNode* Caller, CallTreeNode* Node)
 		Node->SetCaller(RootNode);
 		RootNode->insertCallee(Node);
 	}
-	else{
-		for(CallTreeNode* VecNode : DeclarationVector){
-			// it is not allowed to append a Node to itself, in the Code this is also not possible
-			if(VecNode->compare(Caller) && VecNode != Caller){
-				#ifdef DEBUG
-					std::cout << "Hänge gerade "<< *VecNode->GetID()<<" Typ: "<< VecNode->GetNodeType() << " an " << *Caller->GetID() << " Typ: " << Caller->GetNodeType() <<" an"<< std::endl;
-				#endif
-				VecNode->SetCaller(Caller);
-				Caller->insertCallee(VecNode);
-				break;
-			}
-
-		}
+	// it is not allowed to append a Node to itself, in the Code this is also not possible
+	else if(Node != Caller){
+		#ifdef DEBUG
+			std::cout << "Hänge gerade "<< *Node->GetID()<<" Typ: "<< Node->GetNodeType() << " an " << *Caller->GetID() << " Typ: " << Caller->GetNodeType() <<" an"<< std::endl;
+		#endif
+		Node->SetCaller(Caller);
+		Caller->insertCallee(Node);
 	}
 }
 
@@ -443,20 +588,15 @@ void CallTree::appendCallerToNode(FunctionNode* Caller, CallTreeNode* Node)
 		RootNode->insertCallee(Node);
 	}
 	else{
-			for(CallTreeNode* DeclOfCaller : this->DeclarationVector){
+			auto Decls = DeclsByHash.find(Caller->GetHash());
+			if(Decls != DeclsByHash.end()){
+				CallTreeNode* DeclOfCaller = DeclarationVector[Decls->second.front()];
 				#ifdef DEBUG
-					if(Node->GetID()->getIdentificationString() == "TQ1"){
-						std::cout << "for TQ1 checking Declaration: "<< *DeclOfCaller->GetID() << '\n';
-					}
+					std::cout << "comparison successful. Appending "<<*DeclOfCaller->GetID()<<"as Caller" << '\n';
 				#endif
-				if(DeclOfCaller->compare(Caller->GetHash())){
-					#ifdef DEBUG
-						std::cout << "comparison successful. Appending "<<*DeclOfCaller->GetID()<<"as Caller" << '\n';
-					#endif
-					Node->SetCaller(DeclOfCaller);
-					DeclOfCaller->insertCallee(Node);
-					return;
-				}
+				Node->SetCaller(DeclOfCaller);
+				DeclOfCaller->insertCallee(Node);
+				return;
 			}
 			std::cout << "Something went wrong could not find DeclOfCaller in DeclVector (Function)" << '\n';
 		}
@@ -469,12 +609,12 @@ void CallTree::appendCallerToNode(PatternCodeRegion* Caller, CallTreeNode* Node)
 		RootNode->insertCallee(Node);
 	}
 	else{
-			for(CallTreeNode* DeclOfCaller : this->DeclarationVector){
-				if(DeclOfCaller->compare(Caller->GetID())){
-					Node->SetCaller(DeclOfCaller);
-					DeclOfCaller->insertCallee(Node);
-					return;
-				}
+			auto Decls = DeclsByID.find(Caller->GetIDAtom());
+			if(Decls != DeclsByID.end()){
+				CallTreeNode* DeclOfCaller = DeclarationVector[Decls->second.front()];
+				Node->SetCaller(DeclOfCaller);
+				DeclOfCaller->insertCallee(Node);
+				return;
 			}
 			std::cout << "Something went wrong could not find DeclOfCaller in DeclVector (Pattern)" << '\n';
 	}
@@ -485,29 +625,219 @@ void CallTree::insertNodeIntoPattern_EndVector(CallTreeNode* Node)
 	Pattern_EndVector.push_back(Node);
 }
 
+void CallTree::insertNode(CallTreeNode* Node)
+{
+	if(Node->GetNodeType() == Pattern_Begin || Node->GetNodeType() == Function_Decl)
+		insertNodeIntoDeclVector(Node);
+	else if(Node->GetNodeType() == Pattern_End)
+		insertNodeIntoPattern_EndVector(Node);
+}
+
 void CallTree::insertNodeIntoDeclVector(CallTreeNode* Node)
 {
 	DeclarationVector.push_back(Node);
+	IndexDeclaration(DeclarationVector.size() - 1);
+}
+
+void CallTree::IndexDeclaration(unsigned Pos)
+{
+	Identification* ident = DeclarationVector[Pos]->GetID();
+	DeclsByHash[ident->getIdentificationUnsigned()].push_back(Pos);
+	DeclsByID[ident->getIdentificationAtom()].push_back(Pos);
+}
+
+void CallTree::RebuildDeclIndices()
+{
+	DeclsByHash.clear();
+	DeclsByID.clear();
+
+	for (unsigned Pos = 0; Pos < DeclarationVector.size(); Pos++)
+	{
+		IndexDeclaration(Pos);
+	}
 }
 
-void CallTree::appendAllDeclToCallTree(CallTreeNode* Node, int maxdepth)
+std::vector<unsigned> CallTree::FindDeclsOfCallees(CallTreeNode* Node)
+{
+	std::vector<unsigned> Positions;
+
+	for (CallTreeNode* Callee : Node->GetCallees())
+	{
+		Identification* CalleeID = Callee->GetID();
+
+		if (Callee->GetNodeType() == Pattern_End)
+		{
+			continue;
+		}
+
+		/* A declaration matches by its hash if its ID is empty, otherwise by its ID (see Identification::compare()) */
+		auto ByHash = DeclsByHash.find(CalleeID->getIdentificationUnsigned());
+		if (ByHash != DeclsByHash.end())
+		{
+			for (unsigned Pos : ByHash->second)
+			{
+				if (DeclarationVector[Pos]->GetID()->getIdentificationAtom() == 0)
+				{
+					Positions.push_back(Pos);
+				}
+			}
+		}
+
+		if (CalleeID->getIdentificationAtom() != 0)
+		{
+			auto ByID = DeclsByID.find(CalleeID->getIdentificationAtom());
+			if (ByID != DeclsByID.end())
+			{
+				Positions.insert(Positions.end(), ByID->second.begin(), ByID->second.end());
+			}
+		}
+	}
+
+	std::sort(Positions.begin(), Positions.end());
+	Positions.erase(std::unique(Positions.begin(), Positions.end()), Positions.end());
+	return Positions;
+}
+
+void CallTree::appendAllDeclToCallTree(CallTreeNode* Root)
+{
+	if(Root == NULL)
+		return;
+
+	llvm::DenseMap<CallTreeNode*, unsigned> SCCs;
+	llvm::DenseSet<CallTreeNode*> Expanded;
+	std::vector<std::pair<CallTreeNode*, CallTreeNode*>> RecursiveCalls;
+
+	ComputeDeclSCCs(Root, SCCs);
+	ExpandDecl(Root, SCCs, Expanded, RecursiveCalls);
+
+	/*
+	 * The recursive calls are appended last. They must not replace the caller of the declaration from outside of the recursion,
+	 * otherwise the path from a Pattern_End back to its Pattern_Begin (see findCorrespBegin()) would run in a cycle.
+	 */
+	for(auto &Call : RecursiveCalls){
+		CallTreeNode* DeclOfCallee = Call.second;
+		CallTreeNode* OuterCaller = DeclOfCallee->GetCaller();
+		appendCallerToNode(Call.first, DeclOfCallee);
+		DeclOfCallee->SetCaller(OuterCaller);
+	}
+}
+
+void CallTree::ExpandDecl(CallTreeNode* Node, llvm::DenseMap<CallTreeNode*, unsigned>& SCCs, llvm::DenseSet<CallTreeNode*>& Expanded, std::vector<std::pair<CallTreeNode*, CallTreeNode*>>& RecursiveCalls)
 {
 	#ifdef DEBUG
 		std::cout << "appen AllDecl of " << *Node->GetID()<< std::endl;
 	#endif
-	if(maxdepth > 0 ){
-	 for(CallTreeNode* DeclOfCallee : DeclarationVector){
-		for(const auto &CalleeOfNodePair : *Node->GetCallees()){
-			CallTreeNode* CalleeOfNode = CalleeOfNodePair.second;
+	Expanded.insert(Node);
+
+	/* Only the declarations which match a callee of Node are visited, in the order of the DeclarationVector */
+	std::vector<unsigned> Decls = FindDeclsOfCallees(Node);
+	size_t NumCallees = Node->GetCallees().size();
+	size_t Next = 0;
+	while(Next < Decls.size()){
+		unsigned Pos = Decls[Next++];
+		CallTreeNode* DeclOfCallee = DeclarationVector[Pos];
+		// the callees are indexed, because the recursion can append callees to Node
+		for(size_t i = 0; i < Node->GetCallees().size(); i++){
+			CallTreeNode* CalleeOfNode = Node->GetCallees()[i];
 			if(CalleeOfNode->GetNodeType() != Pattern_End  && CalleeOfNode->compare(DeclOfCallee)){
 				//falls die Kinder von Node die gleiche indentität haben wie eine deklaration im Declaration Vector dann...
 				#ifdef DEBUG
 					std::cout << "appended "<< *CalleeOfNode->GetID()<< "as a Caller to "<<*DeclOfCallee->GetID() << '\n';
 				#endif
-				appendCallerToNode(CalleeOfNode, DeclOfCallee);
-				appendAllDeclToCallTree(DeclOfCallee, maxdepth - 1);
+				auto SCCOfNode = SCCs.find(Node);
+				auto SCCOfDecl = SCCs.find(DeclOfCallee);
+				if(SCCOfNode != SCCs.end() && SCCOfDecl != SCCs.end() && SCCOfNode->second == SCCOfDecl->second)
+					RecursiveCalls.push_back(std::make_pair(CalleeOfNode, DeclOfCallee));
+				else
+					appendCallerToNode(CalleeOfNode, DeclOfCallee);
+
+				// every declaration is expanded only once, all calls of a function share the subtree of its declaration
+				if(!Expanded.count(DeclOfCallee))
+					ExpandDecl(DeclOfCallee, SCCs, Expanded, RecursiveCalls);
 			}
-		 }
+		}
+		// the recursion can append callees to Node, which may match declarations further back in the DeclarationVector
+		if(Node->GetCallees().size() != NumCallees){
+			NumCallees = Node->GetCallees().size();
+			Decls = FindDeclsOfCallees(Node);
+			Next = std::upper_bound(Decls.begin(), Decls.end(), Pos) - Decls.begin();
+		}
+	}
+}
+
+void CallTree::ComputeDeclSCCs(CallTreeNode* Root, llvm::DenseMap<CallTreeNode*, unsigned>& SCCs)
+{
+	/* Iterative version of Tarjan's algorithm, a declaration is connected to the declarations of its callees */
+	struct Frame
+	{
+		CallTreeNode* Node;
+		std::vector<unsigned> Decls;
+		size_t Next;
+	};
+
+	llvm::DenseMap<CallTreeNode*, unsigned> Index;
+	llvm::DenseMap<CallTreeNode*, unsigned> LowLink;
+	llvm::DenseSet<CallTreeNode*> OnStack;
+	std::vector<CallTreeNode*> Stack;
+	std::vector<Frame> DFS;
+	unsigned NextIndex = 0;
+	unsigned NumSCCs = 0;
+
+	auto Visit = [&](CallTreeNode* Node)
+	{
+		Index[Node] = NextIndex;
+		LowLink[Node] = NextIndex;
+		NextIndex++;
+		Stack.push_back(Node);
+		OnStack.insert(Node);
+		DFS.push_back(Frame{Node, FindDeclsOfCallees(Node), 0});
+	};
+
+	Visit(Root);
+
+	while (!DFS.empty())
+	{
+		Frame& Top = DFS.back();
+
+		if (Top.Next < Top.Decls.size())
+		{
+			CallTreeNode* Node = Top.Node;
+			CallTreeNode* Decl = DeclarationVector[Top.Decls[Top.Next++]];
+
+			if (!Index.count(Decl))
+			{
+				Visit(Decl);
+			}
+			else if (OnStack.count(Decl))
+			{
+				LowLink[Node] = std::min(LowLink[Node], Index[Decl]);
+			}
+
+			continue;
+		}
+
+		CallTreeNode* Node = Top.Node;
+		DFS.pop_back();
+
+		if (!DFS.empty())
+		{
+			CallTreeNode* Parent = DFS.back().Node;
+			LowLink[Parent] = std::min(LowLink[Parent], LowLink[Node]);
+		}
+
+		if (LowLink[Node] == Index[Node])
+		{
+			CallTreeNode* Member;
+
+			do
+			{
+				Member = Stack.back();
+				Stack.pop_back();
+				OnStack.erase(Member);
+				SCCs[Member] = NumSCCs;
+			} while (Member != Node);
+
+			NumSCCs++;
 		}
 	}
 }
@@ -519,9 +849,10 @@ void CallTree::setUpTree(){
 			std::cout << *Node->GetID() << '\n';
 		}
 	#endif
+	CallerPaths.clear();
 	for(CallTreeNode* EndNode : Pattern_EndVector){
 		if(EndNode->getCorrespondingCodeRegion()== NULL){
-			PatternCodeRegion* CorrespReg = PatternIDisUsed(EndNode->GetID()->getIdentificationString());
+			PatternCodeRegion* CorrespReg = Graph->PatternIDisUsed(EndNode->GetID()->getIdentificationString());
 			EndNode->setCorrespondingNode(CorrespReg);
 		}
 		else{
@@ -560,61 +891,108 @@ void CallTree::setUpTree(){
 		exept.what();
 		throw TerminateEarlyException();
 	}
+	CallerPaths.clear();
 }
 
 CallTreeNode* CallTree::findCorrespBegin(CallTreeNode* EndNode){
 	if(EndNode->GetNodeType() != Pattern_End)
 		return NULL;
 
-	CallTreeNode* Caller = EndNode->GetCaller();
-	CallTreeNode* Callertemp = EndNode;
+	/* Only the Pattern_Begins above the EndNode can correspond to it, so we jump from one to the next */
+	CallerPathInfo EndPath = GetCallerPath(EndNode);
+	CallTreeNode* Begin = EndPath.PatternBegin;
+	CallTreeNode* ChildOfBegin = EndPath.ChildOfPatternBegin;
 
-	#ifdef CURRDEBUG
-		std::cout << "Actual Caller: "<< *Caller->GetID()<<std::endl;
-	#endif
-
-	bool hasBegin = false;
-
-	while(!hasBegin){
-		if (Caller == NULL)
+	while(true){
+		if (Begin == NULL)
 			throw TooManyEndsException(EndNode->GetID()->getIdentificationString());
 
 		#ifdef CURRDEBUG
-			std::cout << "Actual Caller: " << '\n';
-			if(Caller != NULL)
-			std::cout<<	*Caller->GetID();
-			else
-				std::cout << "The Caller does not exist." << '\n';
-			std::cout << "Actual Node: "<< '\n';
-			Callertemp->print();
+			std::cout << "Actual Begin: " << *Begin->GetID() << '\n';
 		#endif
 
-		Caller->setLOCTillPatternEnd(Callertemp, EndNode);
-		hasBegin = Caller->compare(EndNode);
+		if(Begin->compare(EndNode))
+			break;
 
-		if(Caller->GetNodeType() == Pattern_Begin && !hasBegin){
-			EndNode->setSuitedForNestingStatisticsTo(false);
-			Caller->setSuitedForNestingStatisticsTo(false);
+		EndNode->setSuitedForNestingStatisticsTo(false);
+		Begin->setSuitedForNestingStatisticsTo(false);
+		TimeReport::Count(TRC_NestingMismatches);
 
-			std::cout << "PRINTING PATTERN THAT ARE NOT SUITED FOR STATISTICS WHICH NEED CLEAR NESTING" << '\n';
-			std::cout << "Pattern " << *EndNode->GetID()<<" and "<< *Caller->GetID()<< " is not suited for statistics which need clear nesting of Pattern. " << '\n';
-			std::cout << "The first Pattern_Begin occurence before the Pattern_End of "<<*EndNode->GetID()<<" is "<< *Caller->GetID() << '\n';
-		}
+		std::cout << "PRINTING PATTERN THAT ARE NOT SUITED FOR STATISTICS WHICH NEED CLEAR NESTING" << '\n';
+		std::cout << "Pattern " << *EndNode->GetID()<<" and "<< *Begin->GetID()<< " is not suited for statistics which need clear nesting of Pattern. " << '\n';
+		std::cout << "The first Pattern_Begin occurence before the Pattern_End of "<<*EndNode->GetID()<<" is "<< *Begin->GetID() << '\n';
 
-		if(hasBegin){
-			Caller->setCorrespCallTreeNodeRelation(EndNode);
-			EndNode->setCorrespCallTreeNodeRelation(Caller);
-			break;
-		}
+		CallerPathInfo BeginPath = GetCallerPath(Begin);
+		Begin = BeginPath.PatternBegin;
+		ChildOfBegin = BeginPath.ChildOfPatternBegin;
+	}
+
+	Begin->setLOCTillPatternEnd(EndPath.LOCFromTop - GetCallerPath(Begin).LOCFromTop, ChildOfBegin);
+	Begin->setCorrespCallTreeNodeRelation(EndNode);
+	EndNode->setCorrespCallTreeNodeRelation(Begin);
+	TimeReport::Count(TRC_PatternMatches);
+
+	return Begin;
+}
 
-		Callertemp = Caller;
-		Caller = Callertemp->GetCaller();
+CallTree::CallerPathInfo CallTree::GetCallerPath(CallTreeNode* Node)
+{
+	auto Known = CallerPaths.find(Node);
+	if (Known != CallerPaths.end())
+	{
+		return Known->second;
 	}
 
-	if(hasBegin){
-		return Caller;
+	/* Collect the callers up to the first one with a known path, then fill in the paths from the top down */
+	std::vector<CallTreeNode*> Path;
+	llvm::DenseSet<CallTreeNode*> OnPath;
+	CallTreeNode* Top = Node;
+
+	while (Top != NULL && !CallerPaths.count(Top) && OnPath.insert(Top).second)
+	{
+		Path.push_back(Top);
+		Top = Top->GetCaller();
 	}
-	return NULL;
+
+	/* A caller which is already on the path closes a cycle, it is treated like a missing caller */
+	if (Top != NULL && !CallerPaths.count(Top))
+	{
+		Top = NULL;
+	}
+
+	for (auto It = Path.rbegin(); It != Path.rend(); It++)
+	{
+		CallTreeNode* Current = *It;
+		CallerPathInfo Info = { NULL, NULL, 0 };
+
+		if (Top != NULL)
+		{
+			CallerPathInfo CallerInfo = CallerPaths[Top];
+
+			if (Top->GetNodeType() == Pattern_Begin)
+			{
+				Info.PatternBegin = Top;
+				Info.ChildOfPatternBegin = Current;
+			}
+			else
+			{
+				Info.PatternBegin = CallerInfo.PatternBegin;
+				Info.ChildOfPatternBegin = CallerInfo.ChildOfPatternBegin;
+			}
+
+			// the lines of code within a called function do not count towards the lines between its call and the caller
+			Info.LOCFromTop = CallerInfo.LOCFromTop;
+			if (Current->GetNodeType() != Function_Decl)
+			{
+				Info.LOCFromTop += Current->getLineNumber() - Top->getLineNumber();
+			}
+		}
+
+		CallerPaths[Current] = Info;
+		Top = Current;
+	}
+
+	return CallerPaths[Node];
 }
 
  bool CallTree::lookIfTreeIsCorrect(){
@@ -637,19 +1015,9 @@ std::vector<CallTreeNode*>* CallTree::GetDeclarationVector(){
 	return &DeclarationVector;
 }
 
-CallTreeNode::~CallTreeNode(){
-	std::cout << "loesche gerade Knoten" << '\n';
-}
-
 CallTreeNode::CallTreeNode(CallTreeNodeType type, PatternCodeRegion* CorrespondingPat) : NodeType(type)
 {
-	if(NodeType == Pattern_Begin)
-	{
-		ClTre->insertNodeIntoDeclVector(this);
-	}
-	else if(NodeType == Pattern_End)
-		ClTre->insertNodeIntoPattern_EndVector(this);
-	ident = new Identification(type, CorrespondingPat->GetID());
+	ident = Identification(type, CorrespondingPat->GetID());
 	this->setCorrespondingNode(CorrespondingPat);
 	CorrespondingPat->insertCorrespondingCallTreeNode(this);
 
@@ -665,11 +1033,7 @@ CallTreeNode::CallTreeNode(CallTreeNodeType type, PatternCodeRegion* Correspondi
 
 CallTreeNode::CallTreeNode(CallTreeNodeType type ,FunctionNode* CorrespondingFunction) : NodeType(type)
 {
-	if(NodeType == Function_Decl)
-	{
-		ClTre->insertNodeIntoDeclVector(this);
-	}
-	ident = new Identification(type, CorrespondingFunction->GetHash());
+	ident = Identification(type, CorrespondingFunction->GetHash());
 	this->setCorrespondingNode(CorrespondingFunction);
 	CorrespondingFunction->insertCorrespondingCallTreeNode(this);
 
@@ -681,64 +1045,50 @@ CallTreeNode::CallTreeNode(CallTreeNodeType type ,FunctionNode* CorrespondingFun
 
 CallTreeNode::CallTreeNode(CallTreeNodeType type, std::string identification): NodeType(type)
 {
-	if(NodeType == Pattern_Begin)
-	{
-		ClTre->insertNodeIntoDeclVector(this);
-	}
-	else if(NodeType == Pattern_End){
-		ClTre->insertNodeIntoPattern_EndVector(this);
-	}
-	ident = new Identification(type, identification);
+	ident = Identification(type, identification);
 	#ifdef DEBUG
 		std::cout << "Node of:"<<identification<< " is created"<< '\n';
 		std::cout << "Node Type = " << type << std::endl;
 	#endif
 }
 
-Identification* CallTreeNode::GetID()
+CallTreeNode::CallTreeNode(CallTreeNodeType type, Identification ident): ident(ident), NodeType(type)
 {
-	return this->ident;
 }
 
-std::map<double, CallTreeNode*>* CallTreeNode::GetCallees(){
-	return &Callees;
+Identification* CallTreeNode::GetID()
+{
+	return &this->ident;
 }
 
 CallTreeNode* CallTreeNode::GetCaller(){
 	return this->Caller;
 }
 
-void CallTreeNode::insertCallee(CallTreeNode* Node, double key){
+void CallTreeNode::insertCallee(CallTreeNode* Node){
 	#ifdef DEBUG
 	std::cout << "in insertCallee" << '\n';
 	#endif
 	// it is not allowed to appent the same object (with the same adress) twice
-	if(!isAlreadyCallee(Node)){
+	if(CalleeSet.insert(Node).second){
 		#ifdef DEBUG
-		std::cout << "!isAlreadyCallee = " << !isAlreadyCallee(Node) << '\n';
+		std::cout << "inserting "<< *Node->GetID()<< " at position "<<Callees.size() << '\n';
 		#endif
-		if(key != 0.0){
-			#ifdef DEBUG
-			std::cout << "inserting "<< *Node->GetID()<< " at position "<<key << '\n';
-			#endif
-			Callees[key] = Node;
-		}
-		else{
-			#ifdef DEBUG
-			std::cout << "inserting "<< *Node->GetID()<< " at position "<<actNumOfChild << '\n';
-			#endif
-			Callees[actNumOfChild] = Node;
-			actNumOfChild++;
-		}
+		Callees.push_back(Node);
 	}
 }
 
-bool CallTreeNode::isAlreadyCallee(CallTreeNode* Callee){
-	for(const auto &calleePair: Callees){
-		if(calleePair.second == Callee)
-			return true;
+void CallTreeNode::insertCalleesAfter(CallTreeNode* Position, llvm::ArrayRef<CallTreeNode*> Nodes){
+	std::vector<CallTreeNode*> NewCallees;
+	for(CallTreeNode* Node : Nodes){
+		if(CalleeSet.insert(Node).second)
+			NewCallees.push_back(Node);
 	}
-	return false;
+
+	auto InsertPos = std::find(Callees.begin(), Callees.end(), Position);
+	if(InsertPos != Callees.end())
+		InsertPos++;
+	Callees.insert(InsertPos, NewCallees.begin(), NewCallees.end());
 }
 
 void CallTreeNode::SetCaller(CallTreeNode* Node)
@@ -748,23 +1098,22 @@ void CallTreeNode::SetCaller(CallTreeNode* Node)
 
 bool CallTreeNode::compare(CallTreeNode* otherNode)
 {
-	return ident->compare(otherNode->GetID());
+	return ident.compare(otherNode->GetID());
 }
 
-bool CallTreeNode::compare(unsigned Hash)
+bool CallTreeNode::compare(uint64_t Hash)
 {
-	return ident->compare(Hash);
+	return ident.compare(Hash);
 }
 
 bool CallTreeNode::compare(std::string Id)
 {
-	return ident->compare(Id);
+	return ident.compare(Id);
 }
 
 bool CallTreeNode::isCalleeOf(CallTreeNode* Caller){
-	for(const auto &CalleeOfCallerPair : *Caller->GetCallees())
+	for(CallTreeNode* CalleeOfCaller : Caller->GetCallees())
 	{
-		CallTreeNode* CalleeOfCaller = CalleeOfCallerPair.second;
 		if(this->compare(CalleeOfCaller))
 			return true;
 		return false;
@@ -779,93 +1128,39 @@ void CallTreeNode::print(){
 			std::cout << "END ";
 		}
 		std::cout << CorrespRegion->GetPatternOccurrence()->GetPattern()->GetDesignSpaceStr() << ":\33[33m " << CorrespRegion->GetPatternOccurrence()->GetPattern()->GetPatternName() << "\33[0m";
-			std::cout << "(" << *ident << ")" << std::endl;
+			std::cout << "(" << ident << ")" << std::endl;
 	}
 	else if((NodeType == Function || NodeType == Root) && CorrespondingNode!=NULL && clang::dyn_cast<FunctionNode>(CorrespondingNode)){
 		FunctionNode* CorrespFunc = clang::dyn_cast<FunctionNode>(CorrespondingNode);
-		std::cout << "\033[31m" << CorrespFunc->GetFnName() << "\033[0m" << " (Hash: " << *ident << ")" << std::endl;
+		std::cout << "\033[31m" << CorrespFunc->GetFnName() << "\033[0m" << " (Hash: " << ident << ")" << std::endl;
 	}
 	else if(CorrespondingNode == NULL){
-		std::cout << "\033[36m" << "Only Printing Identification "<< ":\33[33m"<< *ident << "\033[0m" << std::endl;
+		std::cout << "\033[36m" << "Only Printing Identification "<< ":\33[33m"<< ident << "\033[0m" << std::endl;
 	}
 }
 
-void CallTreeNode::setLOCTillPatternEnd(CallTreeNode* Child, CallTreeNode* EndNode){
-	int locNodeToEndNode;
-	if(Child == EndNode){
-		#ifdef LOCDEBUG
-			std::cout << "Child and EndNode are the same." << '\n';
-		#endif
-		EndNode->insertLOCToPatternEnd(EndNode, 0);
-	}
-	if(Child->GetNodeType() == Function_Decl){
-		//copy corresponding entry of Function_Decl
-		auto correspEntry = (Child->getMapLOCToPatternEnds())->find(EndNode);
-		insertLOCToPatternEnd(correspEntry->first, correspEntry->second);
-		#ifdef LOCDEBUG
-			std::cout << "Copy operation:" << '\n';
-			std::cout << "copied "<<  *(correspEntry->first)->GetID()<<" "<< correspEntry->second<< " to "<< *GetID()<< '\n';
-		#endif
-	}
-	else{
-		int correspEntry = (Child->getMapLOCToPatternEnds())->find(EndNode)->second;
-		locNodeToEndNode = correspEntry + (Child->getLineNumber() - getLineNumber());
-		insertLOCToPatternEnd(EndNode, locNodeToEndNode);
-
-		#ifdef LOCDEBUG
-			int storedLineNumber = (getMapLOCToPatternEnds()->find(EndNode))->second;
-			std::cout << "FOR ENDNODE: "<<*EndNode->GetID() << '\n';
-			std::cout << "in setLOCTillPatternEnd: "<< correspEntry << " + "<<  *Child->GetID()<<" "<< Child->getLineNumber() << " - "<< *this->GetID()<<" "<<this->getLineNumber() << "= "<<locNodeToEndNode<< " verification" <<storedLineNumber << '\n';
-		#endif
-	}
-	if(this->compare(EndNode)){
-		locTillPatternEnd = getMapLOCToPatternEnds()->find(EndNode)->second;
-
-		/*delete all Children of the PatternBegin which are't really children
-		 * that means erasing all children which where assigned after this one
-		 * (have higher keys)
-		*/
-		std::map<double, CallTreeNode*>* MapCallees = GetCallees();
-		int childKey;
-		CallTreeNode* callerOfThis = GetCaller();
-		double callerChildKey;
-		std::map<double, CallTreeNode*>* mapCallerCallees = callerOfThis->GetCallees();
-		for(auto nodeEntry = mapCallerCallees->begin() ; nodeEntry != mapCallerCallees->end();){
-			if(nodeEntry->second == this){
-				callerChildKey = nodeEntry->first;
-				break;
-			}
-			else
-				nodeEntry++;
-		}
-
-		for(auto nodeEntry = MapCallees->begin() ; nodeEntry != MapCallees->end();){
-			if(nodeEntry->second == Child){
-				childKey = nodeEntry->first;
-			}//for every Child wich comes after the Child which contains the as the end as an
-			//successor. Delete the Child as A child of Pattern_Begin and add his child
-			// to the Caller of Pattern_Begin
-			if(nodeEntry->first > childKey){
-				#ifdef CHILDDEBUG
-					std::cout << "ERASING "<<nodeEntry->first << *((nodeEntry.second)->GetID()) << '\n';
-				#endif
-				callerChildKey += 0.1;
-				callerOfThis->insertCallee(nodeEntry->second, callerChildKey);
-				nodeEntry = MapCallees->erase(nodeEntry);
-			}
-			else{
-				nodeEntry++;
-			}
+void CallTreeNode::setLOCTillPatternEnd(int LOC, CallTreeNode* Child){
+	locTillPatternEnd = LOC;
 
-		}
-		#ifdef LOCDEBUG
-			std::cout << "set locTillPatternEnd from "<< *GetID()<< " to "<< locTillPatternEnd << '\n';
+	/*delete all Children of the PatternBegin which are't really children
+	 * that means erasing all children which where assigned after Child
+	 * and appending them to the Caller of the Pattern_Begin directly after the Pattern_Begin
+	*/
+	auto ChildPos = std::find(Callees.begin(), Callees.end(), Child);
+	if(ChildPos != Callees.end() && ChildPos + 1 != Callees.end()){
+		std::vector<CallTreeNode*> Trailing(ChildPos + 1, Callees.end());
+		#ifdef CHILDDEBUG
+			for(CallTreeNode* Node : Trailing)
+				std::cout << "ERASING "<< *Node->GetID() << '\n';
 		#endif
-		}
-}
-
-void CallTreeNode::insertLOCToPatternEnd(CallTreeNode* Node, int Loc){
-	LocTillEnds.insert({Node, Loc});
+		Callees.erase(ChildPos + 1, Callees.end());
+		for(CallTreeNode* Node : Trailing)
+			CalleeSet.erase(Node);
+		GetCaller()->insertCalleesAfter(this, Trailing);
+	}
+	#ifdef LOCDEBUG
+		std::cout << "set locTillPatternEnd from "<< *GetID()<< " to "<< locTillPatternEnd << '\n';
+	#endif
 }
 
 void CallTreeNode::setSuitedForNestingStatisticsTo(bool suited){
@@ -877,9 +1172,9 @@ void CallTreeNode::setSuitedForNestingStatisticsTo(bool suited){
 
 std::ostream& operator<<(std::ostream &os, Identification const &ident)
 {
-	if((ident.getIdentificationString()).compare(""))
+	if(ident.getIdentificationAtom() != 0)
 	{
-		return os << ident.getIdentificationString();
+		return os << AtomTable::GetString(ident.getIdentificationAtom()).str();
 
 	}
 	if(ident.getIdentificationUnsigned() != 0){
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "DesignSpaces.h"
+#include "AtomTable.h"
+#include "SourcePosition.h"
 
 #include <string>
 #include <vector>
@@ -8,7 +10,15 @@
 #include <queue>
 #include "clang/AST/Decl.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include <map>
+#include <unordered_map>
+#include <utility>
+#include <memory>
 #include <iostream>
 
 
@@ -21,6 +31,10 @@ class HPCParallelPattern;
 class PatternOccurrence;
 class PatternCodeRegion;
 class CallTreeNode;
+class Identification;
+class GraphSnapshot;
+class FrozenPatternGraph;
+class CodeRegionRange;
 
 
 /**
@@ -53,9 +67,10 @@ public:
 
 	virtual void AddParent(PatternGraphNode* Parent) = 0;
 
-	virtual std::vector<PatternGraphNode*> GetChildren() = 0;
+	/* The accessors return read-only views on the containers of the node, they are invalidated if the node is modified */
+	virtual llvm::ArrayRef<PatternGraphNode*> GetChildren() = 0;
 
-	virtual std::vector<PatternGraphNode*> GetParents() = 0;
+	virtual llvm::ArrayRef<PatternGraphNode*> GetParents() = 0;
 
 	void SetConnectedComponent(int CID) { this->ComponentID = CID; }
 
@@ -71,14 +86,14 @@ private:
 
 /**
  * A FunctionNode is a node in the pattern graph (i.e. inherits from PatternGraphNode), and has children and parents.
- * It contains a hash value to uniquely identify a function declaration across compilation-units.
+ * It contains the USR of the function and a 64 bit hash value of the USR to uniquely identify a function declaration across compilation-units.
  * This is useful if a function is called and we need information from the function body but the function is not defined within the current translation unit.
  * Then, the reference is saved for later until the definition belonging to the function declaration is encountered.
  */
 class FunctionNode : public PatternGraphNode
 {
 public:
-	FunctionNode (std::string Name, unsigned Hash);
+	FunctionNode (std::string Name, uint64_t Hash, Atom USR);
 
 	void AddChild(PatternGraphNode* Child);
 
@@ -86,13 +101,13 @@ public:
 
 	void AddPatternParent(PatternGraphNode* PatParent);
 
-	void AddPatternParents(std::vector<PatternCodeRegion*> PatternParents);
+	void AddPatternParents(llvm::ArrayRef<PatternCodeRegion*> PatternParents);
 
 	void AddPatternChild(PatternGraphNode* PatChild);
 
-	std::vector<PatternCodeRegion*> GetPatternParents();
+	llvm::ArrayRef<PatternCodeRegion*> GetPatternParents() { return PatternParents; }
 
-	std::vector<PatternCodeRegion*> GetPatternChildren();
+	llvm::ArrayRef<PatternCodeRegion*> GetPatternChildren() { return PatternChildren; }
 
 	bool HasNoPatternParents();
 
@@ -100,24 +115,37 @@ public:
 
 	void registerPatChildrenToPatParents();
 
-	void PrintVecOfPattern(std::vector<PatternCodeRegion*> RegionVec);
+	void PrintVecOfPattern(llvm::ArrayRef<PatternCodeRegion*> RegionVec);
 
-	std::vector<PatternGraphNode*> GetChildren()
+	llvm::ArrayRef<PatternGraphNode*> GetChildren()
 	{
 		return Children;
 	}
 
-	std::vector<PatternGraphNode*> GetParents()
+	llvm::ArrayRef<PatternGraphNode*> GetParents()
 	{
 		return Parents;
 	}
 
-	unsigned GetHash()
+	uint64_t GetHash()
 	{
 		return Hash;
 	}
 
+	/**
+	 * @brief Returns the interned USR of the function, which is the same for all declarations of the function in all translation units.
+	 **/
+	Atom GetUSRAtom()
+	{
+		return USR;
+	}
+
 	std::string GetFnName()
+	{
+		return AtomTable::GetString(FnName).str();
+	}
+
+	Atom GetFnNameAtom()
 	{
 		return FnName;
 	}
@@ -132,8 +160,11 @@ public:
 	}
 
 private:
-	std::string FnName;
-	unsigned Hash;
+	friend class GraphSnapshot;
+
+	Atom FnName;
+	uint64_t Hash;
+	Atom USR;
 	// we need only one Parents to trace down the reletion chip of the patterns through different Functions
 
 	std::vector<PatternCodeRegion*> PatternParents;
@@ -147,16 +178,29 @@ private:
 
 
 
+/**
+	* enum is needed to distinguish between the different types of CAllTreeNodes
+  **/
+
+enum CallTreeNodeType{
+	Function, Pattern_Begin, Pattern_End, Function_Decl, Root
+};
+
+/**
+ * The PatternGraph holds the patterns, pattern occurrences, code regions and functions of one analysis.
+ * It is owned by an AnalysisSession, so several analyses can exist in the same process.
+ */
 class PatternGraph
 {
 public:
+	PatternGraph();
 	/**
 	 * @brief Selects and returns the root node for a tree representation.
 	 *
 	 * @return Root Node for tree representation.
 	 **/
 	PatternGraphNode* GetRootNode();
-	std::vector<PatternGraphNode*> GetOnlyPatternRootNodes();
+	llvm::ArrayRef<PatternGraphNode*> GetOnlyPatternRootNodes() { return OnlyPatternRootNodes; }
 	/**
 	 * @brief Adds a parallel pattern to the database.
 	 *
@@ -175,12 +219,14 @@ public:
 	 **/
 	HPCParallelPattern* GetPattern(DesignSpace DesignSp, std::string Name);
 
+	HPCParallelPattern* GetPattern(DesignSpace DesignSp, Atom Name);
+
 	/**
 	 * @brief
 	 *
 	 * @return All patterns registered in the graph.
 	 **/
-	std::vector<HPCParallelPattern*> GetAllPatterns() { return Patterns; }
+	llvm::ArrayRef<HPCParallelPattern*> GetAllPatterns() { return Patterns; }
 	/**
 	 * @brief Adds a PatternOccurrence to the database.
 	 *
@@ -198,6 +244,8 @@ public:
 	 **/
 	PatternOccurrence* GetPatternOccurrence(std::string ID);
 
+	PatternOccurrence* GetPatternOccurrence(Atom ID);
+
 	/**
 	 * @brief
 	 *
@@ -209,24 +257,37 @@ public:
 	 *
 	 * @return All PatternCodeRegion objects linked to this PatternOccurrence
 	 **/
-	std::vector<PatternCodeRegion*> GetAllPatternCodeRegions();
+	CodeRegionRange GetAllPatternCodeRegions();
 
 	/**
 	 * @brief Registers a function with the database in the PatternGraph.
 	 *
 	 * This function registers a FunctionNode object in the PatternGraph class.
 	 * The object is created based on the data extracted from the Clang FunctionDecl object.
-	 * A unique ODR hash value is calculated for identification.
+	 * The hash value of the USR of the function is calculated for identification.
 	 *
 	 * @param Decl The clang function declaration object.
 	 *
 	 * @return False if the function is already registered. Else, true.
 	 **/
 	bool RegisterFunction(clang::FunctionDecl* Decl);
+	/**
+	 * @brief Registers a function from data that has already been extracted from the clang declaration.
+	 *
+	 * This is used when the facts of a translation unit are replayed after its AST has been released (see TranslationUnitLog).
+	 *
+	 * @param Name The name of the function.
+	 * @param Hash The hash value of the USR (see PatternGraph::CalculateFunctionHash()).
+	 * @param USR The interned USR of the function.
+	 * @param IsMain True if the function is the main function.
+	 *
+	 * @return False if the function is already registered. Else, true.
+	 **/
+	bool RegisterFunction(std::string Name, uint64_t Hash, Atom USR, bool IsMain);
 	/**
 	 * @brief Lookup function for the database entry that corresponds to the given function declaration.
 	 *
-	 * This function takes a clang function declaration object as input and calculates an ODR hash value from the object.
+	 * This function takes a clang function declaration object as input and calculates the hash value of its USR.
 	 * This value is then used for lookup of the corresponding entry in our function declaration database to enable linking of function calls and bodies with their declarations between translation units.
 	 *
 	 * @param Decl The clang object that belongs to a function declaration in the source code.
@@ -236,6 +297,41 @@ public:
 	FunctionNode* GetFunctionNode(clang::FunctionDecl* Decl);
 
 	FunctionNode* GetFunctionNode(std::string Name);
+	/**
+	 * @brief Lookup function for the database entry with the given hash value.
+	 *
+	 * @param Hash The hash value calculated by PatternGraph::CalculateFunctionHash().
+	 *
+	 * @return The function declaration database entry or NULL.
+	 **/
+	FunctionNode* GetFunctionNode(uint64_t Hash);
+	/**
+	 * @brief Lookup function for the database entry with the given hash value, which checks that the entry belongs to the same function.
+	 * Throws a FunctionHashCollisionException if a function with a different USR has the same hash value.
+	 *
+	 * @param Hash The hash value calculated by PatternGraph::CalculateFunctionHash().
+	 * @param USR The interned USR of the function.
+	 *
+	 * @return The function declaration database entry or NULL.
+	 **/
+	FunctionNode* GetFunctionNode(uint64_t Hash, Atom USR);
+	/**
+	 * @brief Returns the USR of a function declaration. All declarations and the definition of a function have the same USR, also in different translation units.
+	 * If clang cannot generate a USR, the ODR hash value of the declaration is used instead.
+	 *
+	 * @param Decl The clang function declaration object.
+	 *
+	 * @return The USR.
+	 **/
+	static std::string GetFunctionUSR(clang::FunctionDecl* Decl);
+	/**
+	 * @brief Calculates the 64 bit hash value that identifies a function across translation units.
+	 *
+	 * @param USR The USR of the function (see PatternGraph::GetFunctionUSR()).
+	 *
+	 * @return The hash value.
+	 **/
+	static uint64_t CalculateFunctionHash(llvm::StringRef USR);
 
 	void RegisterOnlyPatternRootNode(PatternCodeRegion* CodeReg);
 
@@ -244,45 +340,103 @@ public:
 	 *
 	 * @return All functions registered in the graph.
 	 **/
-	std::vector<FunctionNode*> GetAllFunctions() { return Functions; }
+	llvm::ArrayRef<FunctionNode*> GetAllFunctions() { return Functions; }
 
 	/**
-	 * @brief Get the instance of the PatternGraph
+	 * @brief Looks up the first code region with the given ID.
+	 * All code regions with the same ID belong to the same PatternOccurrence, so the index of the pattern occurrences is used.
+	 *
+	 * @param ID The ID of the code region.
 	 *
-	 * @return PatternGraph instance
+	 * @return The code region or NULL if the ID is not used yet.
 	 **/
-	static PatternGraph* GetInstance()
-	{
-		static PatternGraph Graph;
-		return &Graph;
-	}
+	PatternCodeRegion* PatternIDisUsed(std::string ID);
+
+	PatternCodeRegion* PatternIDisUsed(Atom ID);
+
+	/**
+	 * @brief The objects of the graph and the call tree are allocated in arenas owned by the PatternGraph.
+	 * They are released together with the graph or by PatternGraph::Reset(), so they must not be deleted individually.
+	 **/
+	HPCParallelPattern* CreatePattern(DesignSpace DesignSp, Atom PatternName);
+
+	PatternOccurrence* CreatePatternOccurrence(HPCParallelPattern* Pattern, Atom ID);
+
+	PatternCodeRegion* CreatePatternCodeRegion(PatternOccurrence* PatternOcc);
+
+	FunctionNode* CreateFunctionNode(std::string Name, uint64_t Hash, Atom USR);
+
+	CallTreeNode* CreateCallTreeNode(CallTreeNodeType NodeType, PatternCodeRegion* CorrespondingPat);
+
+	CallTreeNode* CreateCallTreeNode(CallTreeNodeType NodeType, FunctionNode* CorrespondingFunction);
+
+	CallTreeNode* CreateCallTreeNode(CallTreeNodeType NodeType, std::string Identification);
+
+	/**
+	 * @brief Releases all patterns, code regions, functions and call tree nodes in one step.
+	 * The CallTree of the graph has to be reset as well, see AnalysisSession::Reset().
+	 * All pointers to objects of the previous analysis are invalid after this call.
+	 **/
+	void Reset();
+
+	/**
+	 * @brief Creates the FrozenPatternGraph for the statistics.
+	 * Call this after the call tree has been set up, the parent-child-relations must not change afterwards.
+	 **/
+	void Freeze();
+
+	/**
+	 * @brief Returns the FrozenPatternGraph created by PatternGraph::Freeze(). The graph is frozen now if this has not been done before.
+	 *
+	 * @return The frozen graph.
+	 **/
+	const FrozenPatternGraph* GetFrozenGraph();
+
+	~PatternGraph();
 
 private:
+	friend class GraphSnapshot;
+
 	/* Save patterns, patternoccurrences and functions for later requests and linear access. */
 	std::vector<HPCParallelPattern*> Patterns;
 	std::vector<PatternOccurrence*> PatternOccurrences;
 
 	std::vector<FunctionNode*> Functions;
 
+	/* Indices for the lookup functions, they always contain the same objects as the vectors above */
+	llvm::DenseMap<std::pair<unsigned, Atom>, HPCParallelPattern*> PatternIndex;
+	llvm::DenseMap<Atom, PatternOccurrence*> PatternOccurrenceIndex;
+	std::unordered_map<uint64_t, FunctionNode*> FunctionIndex;
+
+	/**
+	 * @brief Rebuilds the indices from the vectors, e.g. after a GraphSnapshot has been loaded.
+	 **/
+	void RebuildIndices();
+
+	/**
+	 * @brief Creates a call tree node that is not registered in a CallTree, used when a GraphSnapshot is loaded.
+	 **/
+	CallTreeNode* CreateCallTreeNode(CallTreeNodeType NodeType, Identification Ident);
+
+	std::unique_ptr<FrozenPatternGraph> Frozen;
+
+	/* Arenas for the objects of the graph and the call tree, each type is stored contiguously */
+	llvm::SpecificBumpPtrAllocator<HPCParallelPattern> PatternAllocator;
+	llvm::SpecificBumpPtrAllocator<PatternOccurrence> PatternOccurrenceAllocator;
+	llvm::SpecificBumpPtrAllocator<PatternCodeRegion> CodeRegionAllocator;
+	llvm::SpecificBumpPtrAllocator<FunctionNode> FunctionAllocator;
+	llvm::SpecificBumpPtrAllocator<CallTreeNode> CallTreeNodeAllocator;
+
 	/* Designated root node for output in "Treeifyed" display */
 	PatternGraphNode* RootNode;
 	/* When using the OnlyPattern flag we can have multiple rootPatterns*/
 	std::vector<PatternGraphNode*> OnlyPatternRootNodes;
 
-	/* Prevent object creation */
-	PatternGraph();
+	/* Prevent copies, the nodes point to each other */
 	PatternGraph(const PatternGraph&);
 	PatternGraph& operator = (const PatternGraph&);
 };
 
-/**
-	* enum is needed to distinguish between the different types of CAllTreeNodes
-  **/
-
-enum CallTreeNodeType{
-	Function, Pattern_Begin, Pattern_End, Function_Decl, Root
-};
-
 /**
 	* Whith the help of the Identification class we are able to easily print and compare the IDs of the Pattern/ Hash values of the Functions.
   **/
@@ -290,7 +444,6 @@ enum CallTreeNodeType{
 class Identification
 {
 public:
-	~Identification();
 	Identification();
 	/**
 		* Constructor for Identifications of CallTreeNodes which have a pattern as basis
@@ -299,7 +452,7 @@ public:
 	/**
 		* Constructor for Identifications of CallTreeNodes which have a function as basis
 	  **/
-	Identification(CallTreeNodeType type, unsigned identification);
+	Identification(CallTreeNodeType type, uint64_t identification);
 	/**
 		* Helps to compare the different Call TreeNodes without having to make
 		* a distinction between the different types of the nodes.
@@ -315,7 +468,7 @@ public:
 		* then the nodes are having the same pattern or function as basis
 		* (overloaded function)
 		**/
-	bool compare(unsigned Hash);
+	bool compare(uint64_t Hash);
 	/**
 		* Helps to compare the different Call TreeNodes without having to make
 		* a distinction between the different types of the nodes.
@@ -327,15 +480,19 @@ public:
 	/**
 		* returns the IdentificationString which is equivalent to the ID of a PatternCodeRegion
 		**/
-	std::string  getIdentificationString() const {return IdentificationString;};
+	std::string  getIdentificationString() const {return AtomTable::GetString(IdentificationAtom).str();};
+	/**
+		* returns the interned ID of a PatternCodeRegion, 0 if the Identification belongs to a function
+		**/
+	Atom getIdentificationAtom() const {return IdentificationAtom;};
 	/**
 		* returns the IdentificationUnsigned which is equivalent to the hash value of a Function
 		**/
-	unsigned getIdentificationUnsigned() const {return IdentificationUnsigned;};
+	uint64_t getIdentificationUnsigned() const {return IdentificationUnsigned;};
 
 private:
-	std::string IdentificationString = "";
-	unsigned IdentificationUnsigned = 0;
+	Atom IdentificationAtom = 0;
+	uint64_t IdentificationUnsigned = 0;
 };
 
 /**
@@ -363,9 +520,9 @@ public:
 		**/
 	~CallTree();
 	/**
-		* Constructor of a CallTree
+		* Constructor of a CallTree. The CallTreeNodes are allocated in the arenas of the Graph and refer to its nodes.
 		**/
-	CallTree();
+	CallTree(PatternGraph* Graph);
 	/**
 		* Registers a CallTreeNode with the correct relation to the Caller. For Nodes which have
 		* a PatternCodeRegion(Pattern) as basis
@@ -389,6 +546,7 @@ public:
 	void setRootNode(CallTreeNode* root);
 	/**
 		*Overloaded function. Registers the Caller as caller of Node in the CallTree.
+		*Node is linked itself, even if there are several declarations with its identification (e.g. a prototype and the definition in the same file).
 		**/
 	void appendCallerToNode(CallTreeNode* Caller, CallTreeNode* Node);
 	/**
@@ -409,8 +567,9 @@ public:
 	void insertNodeIntoDeclVector(CallTreeNode* Node);
 	/**
 		*During the traversation we are not able to tell which CallTreeNode is called by another node. That is because the traversation of the code is not in call order. This function ensures the right relation of the different CallTreeNode and is called after the traversation of the code.
+		*Every declaration is expanded once and shared by all of its calls, so the tree is complete at any depth. Recursive functions are detected as strongly connected components of the declarations.
 		**/
-	void appendAllDeclToCallTree(CallTreeNode* Root, int maxdepth);
+	void appendAllDeclToCallTree(CallTreeNode* Root);
 	/**
 		*@brief  Only after calling appendAllDeclToCallTree it is possible to see if the Pattern_Begin have the correct Children. Highly likely they have too much children.
 		In this function we trace back the path to from a CallTreeNode corresponding to a Pattern_End to the fitting CallTreeNode which corresponds to a Pattern_Begin.
@@ -433,7 +592,19 @@ public:
 		* returns the root of the CallTree.
 		**/
 	CallTreeNode* getRoot(){return RootNode;};
+	/**
+		* Forgets all CallTreeNodes. The nodes themselves are owned by the PatternGraph and released in PatternGraph::Reset().
+		**/
+	void Reset();
 private:
+	friend class GraphSnapshot;
+
+	PatternGraph* Graph;
+	/**
+		* Inserts a newly created CallTreeNode into the DeclarationVector or the Pattern_EndVector, depending on its type.
+		**/
+	void insertNode(CallTreeNode* Node);
+
 	//we store the Pattern in a Vector so we can go up to the parents
 	std::vector<CallTreeNode*> Pattern_EndVector;
 	// the RootNode is the main function, which is probably named differently
@@ -442,6 +613,45 @@ private:
 		*This vector stores all CallTreeNodes which are corresponding to a function declaration or a Pattern_Begin
 		**/
 	std::vector<CallTreeNode*> DeclarationVector;
+	/**
+		* Positions of the nodes in the DeclarationVector, indexed by the hash and by the ID of their Identification.
+		* The positions of every key are in ascending order, so a lookup finds the same node as a scan of the DeclarationVector.
+		**/
+	std::unordered_map<uint64_t, std::vector<unsigned>> DeclsByHash;
+	std::unordered_map<Atom, std::vector<unsigned>> DeclsByID;
+
+	void IndexDeclaration(unsigned Pos);
+
+	void RebuildDeclIndices();
+	/**
+		* Returns the sorted positions of all declarations which are equal to a callee of Node, ignoring Pattern_Ends.
+		**/
+	std::vector<unsigned> FindDeclsOfCallees(CallTreeNode* Node);
+	/**
+		* Appends the declarations of the callees of Node and expands them, if they have not been expanded yet.
+		* Calls between declarations of the same strongly connected component are collected in RecursiveCalls.
+		**/
+	void ExpandDecl(CallTreeNode* Node, llvm::DenseMap<CallTreeNode*, unsigned>& SCCs, llvm::DenseSet<CallTreeNode*>& Expanded, std::vector<std::pair<CallTreeNode*, CallTreeNode*>>& RecursiveCalls);
+	/**
+		* Numbers the strongly connected components of the declarations reachable from Root.
+		**/
+	void ComputeDeclSCCs(CallTreeNode* Root, llvm::DenseMap<CallTreeNode*, unsigned>& SCCs);
+	/**
+		* Summary of the path from a CallTreeNode up along its callers: the nearest Pattern_Begin above the node,
+		* the node directly below this Pattern_Begin on the path and the lines of code from the top of the path to the node.
+		**/
+	struct CallerPathInfo
+	{
+		CallTreeNode* PatternBegin;
+		CallTreeNode* ChildOfPatternBegin;
+		int LOCFromTop;
+	};
+	/**
+		* The caller paths are computed once for every node in setUpTree(), the callers do not change there.
+		**/
+	llvm::DenseMap<CallTreeNode*, CallerPathInfo> CallerPaths;
+
+	CallerPathInfo GetCallerPath(CallTreeNode* Node);
 };
 
 /**
@@ -452,10 +662,6 @@ private:
 class CallTreeNode
 {
 public:
-	/**
-		*Destructor.
-		**/
-	~CallTreeNode();
 	/**
 		*Constructor of a CallTreeNode eather corresponding to a Pattern_End or a Pattern_Begin.
 		**/
@@ -473,22 +679,26 @@ public:
 		**/
 	Identification* GetID();
 	/**
-		* Returns a pointer of the Callee std::map.
+		* Returns the Callees in the order of the source code. The view is invalidated if a callee is inserted.
 		**/
-	std::map<double, CallTreeNode*>* GetCallees();
+	llvm::ArrayRef<CallTreeNode*> GetCallees(){return Callees;};
 	/**
 		* Returns a pointer of the CallTreeNode Caller.
 		**/
 	CallTreeNode* GetCaller();
 	/**
-		* Inserts a CallTreeNode into the Callee std::map.
+		* Appends a CallTreeNode to the Callees.
+		**/
+	void insertCallee(CallTreeNode* Node);
+	/**
+		* Inserts the CallTreeNodes Nodes into the Callees directly after the callee Position, keeping their order.
 		**/
-	void insertCallee(CallTreeNode* Node,double key = 0.0);
+	void insertCalleesAfter(CallTreeNode* Position, llvm::ArrayRef<CallTreeNode*> Nodes);
 	/**
-		* Proofes if a CallTreeNode Callee is already in the Callee std::map.
-		* returns 1 if Callee is already stored in the Callee std::map otherwise 0.
+		* Proofes if a CallTreeNode Callee is already one of the Callees.
+		* returns 1 if Callee is already stored in the Callees otherwise 0.
 		**/
-	bool isAlreadyCallee(CallTreeNode* Callee);
+	bool isAlreadyCallee(CallTreeNode* Callee){return CalleeSet.count(Callee);};
 	/**
 		* Declares the CallTreeNode Node to the Caller of this.
 		**/
@@ -500,7 +710,7 @@ public:
 	/**
 		* returns 1 if the node has the same underlying function/pattern otherwise 0
 		**/
-	bool compare(unsigned Hash);
+	bool compare(uint64_t Hash);
 	/**
 		* returns 1 if the node has the same underlying function/pattern otherwise 0
 		**/
@@ -520,13 +730,17 @@ public:
 		**/
 	CallTreeNodeType GetNodeType(){return NodeType;};
 	/**
-		* Declares the int lineNumber of this.
+		* Declares the position of the declaration, call or instrumentation call belonging to this.
+		**/
+	void SetPosition(SourcePosition Pos){Position = Pos;};
+	/**
+		* Returns the position of this.
 		**/
-	void SetLineNumber(int Loc){lineNumber = Loc;};
+	SourcePosition GetPosition(){return Position;};
 	/**
-		* Returns the int lineNumber of this.
+		* Returns the line number of the position of this.
 		**/
-	int getLineNumber(){return lineNumber;};
+	int getLineNumber(){return Position.Line;};
 	/**
 		* Sets the GraphNode CorrespondingNode to Node. This declares wo which GraphNode (PatternCodeRegion of FunctionNode) <b>this</b> belongs.
 		**/
@@ -553,22 +767,14 @@ public:
 		**/
 	CallTreeNode* getCorrespCallTreeNodeRelation(){return correspPatCallNode;}
 	/**
-		* This function stores amount of lines between this and EndNode. Child has to be a direct Child of this and EndNode has to be already within the std::map LocTillEnds of Child.
-		* If the Child is a Function_Decl the belonging entry (the entry of EndNode) is only copied in the std::map LocTillEnds of this.
+		* Stores the number of lines between this Pattern_Begin and its Pattern_End. Child has to be the direct Child of this through which the Pattern_End is reached.
+		* All children of this after Child are not enclosed by the pattern and are moved to the Caller of this.
 		**/
-	void setLOCTillPatternEnd(CallTreeNode* Child,  CallTreeNode* EndNode);
+	void setLOCTillPatternEnd(int LOC, CallTreeNode* Child);
 	/**
 		* This stores the number of lines between a Patten_End and a Pattern_Begin. But it should be only read  in the CallTreeNode corresponding to the Pattern_Begin.
 		**/
 	int* getLOCTillPatternEnd(){return &locTillPatternEnd;};
-	/**
-		* Returns the std::map LocTillEnds which at the end of the traversation should contain all lines of code to all Pattern_Ends which surround  this CallTreeNode. (All the patterns in which are a parent of this CallTreeNode.)
-		**/
-	std::map<CallTreeNode*, int>* getMapLOCToPatternEnds(){return &LocTillEnds;};
-	/**
-		* Inserts a Node (key) and a number in LocTillEnds.
-		**/
-	void insertLOCToPatternEnd(CallTreeNode* Node, int Loc);
 	/**
 		* sets the is suited bool from the corresponding Pattern to zero
 		**/
@@ -576,10 +782,17 @@ public:
 
 	bool isSuitedForNestingStatistics = true;
 	private:
+	friend class GraphSnapshot;
+	friend class PatternGraph;
+	/**
+		* Constructor used when a CallTree is restored from a GraphSnapshot.
+		**/
+	CallTreeNode(CallTreeNodeType type, Identification ident);
 	/**The identification does not identify the CallTreeNode but it identifies the
 	  *belonging Pattern or Function. This class makes it easier to get the ID wich is a string or a hash value without the need to distinguish between the different NodeTypes.
+		* It is stored inline, so no separate allocation is needed for every node.
 		**/
-	Identification* ident;
+	Identification ident;
 	/**
 		* Identifies the Caller of the current CallTreeNode.
 		**/
@@ -589,34 +802,28 @@ public:
 		**/
 	PatternGraphNode* CorrespondingNode = NULL;
 	/**
-		* This is an std::map which holds all Callees at the end of the traversation.
+		* This holds all Callees at the end of the traversation. A child which appears earlier in the analyzed sourcecode comes first.
 		**/
-	std::map<double, CallTreeNode*> Callees;
+	std::vector<CallTreeNode*> Callees;
 	/**
-		*	This is used to define the order of the children of a CallTreeNode. A child which appears earlier in the analyzed sourcecode has a lower int value in LocTillEns.
+		* The same nodes as in Callees, so a node is not appended twice.
 		**/
-	int actNumOfChild = 0;
+	llvm::SmallPtrSet<CallTreeNode*, 4> CalleeSet;
 	/**
 		* This holds the Lines of Code between a PattenBegin to the CorespondingPatternEnd. Only redable from the CallTreeNode corresponding to the Pattern_Begin.
 		**/
 	int locTillPatternEnd = 0;
-	/**
-		* After the traversation this should store the distance in lines of Code, of all enclosing Pattern, between a CallTreeNode coresponding to a Pattern_End and this.
-		**/
-	std::map<CallTreeNode*, int> LocTillEnds;
 	/**
 		* Stores the type of this CallTreeNode. Can range between Root, Function_Decl, Function, Pattern_Begin and Pattern_End
 		**/
 	const CallTreeNodeType NodeType;
 	/**
-		* stores the line Number in the analyzed sourcecode belonging to this CallTreeNode.
+		* stores the position in the analyzed sourcecode belonging to this CallTreeNode.
 		**/
-	int lineNumber;
+	SourcePosition Position;
 	/**
 		* Stores the corresponding Pattern_Begin/Pattern_End to a Pattern_End/Pattern_Begin.
 		**/
 	CallTreeNode* correspPatCallNode = NULL;
 };
 
-//
-extern CallTree* ClTre;
@@ -0,0 +1,163 @@
+#include "Serialization.h"
+
+#include <cstring>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+
+
+BinaryWriter::BinaryWriter() : Buffer()
+{
+}
+
+void BinaryWriter::WriteU8(uint8_t Value)
+{
+	Buffer.push_back((char)Value);
+}
+
+void BinaryWriter::WriteU32(uint32_t Value)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		Buffer.push_back((char)((Value >> (8 * i)) & 0xFF));
+	}
+}
+
+void BinaryWriter::WriteU64(uint64_t Value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		Buffer.push_back((char)((Value >> (8 * i)) & 0xFF));
+	}
+}
+
+void BinaryWriter::WriteDouble(double Value)
+{
+	uint64_t Bits;
+	std::memcpy(&Bits, &Value, sizeof(Bits));
+	WriteU64(Bits);
+}
+
+void BinaryWriter::WriteString(llvm::StringRef Str)
+{
+	WriteU32(Str.size());
+	Buffer.append(Str.data(), Str.size());
+}
+
+bool BinaryWriter::WriteToFile(llvm::StringRef Path)
+{
+	llvm::SmallString<256> TempPath;
+	int FD;
+
+	if (llvm::sys::fs::createUniqueFile(Path + ".%%%%%%.tmp", FD, TempPath))
+	{
+		return false;
+	}
+
+	{
+		llvm::raw_fd_ostream Out(FD, true);
+		Out << Buffer;
+		Out.close();
+
+		if (Out.has_error())
+		{
+			Out.clear_error();
+			llvm::sys::fs::remove(TempPath);
+			return false;
+		}
+	}
+
+	if (llvm::sys::fs::rename(TempPath, Path))
+	{
+		llvm::sys::fs::remove(TempPath);
+		return false;
+	}
+
+	return true;
+}
+
+
+
+BinaryReader::BinaryReader(llvm::StringRef Data) : Data(Data)
+{
+}
+
+bool BinaryReader::Require(size_t NumBytes)
+{
+	if (Failed || Data.size() - Pos < NumBytes)
+	{
+		Failed = true;
+		return false;
+	}
+
+	return true;
+}
+
+uint8_t BinaryReader::ReadU8()
+{
+	if (!Require(1))
+	{
+		return 0;
+	}
+
+	return (uint8_t)Data[Pos++];
+}
+
+uint32_t BinaryReader::ReadU32()
+{
+	if (!Require(4))
+	{
+		return 0;
+	}
+
+	uint32_t Value = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		Value |= ((uint32_t)(uint8_t)Data[Pos++]) << (8 * i);
+	}
+
+	return Value;
+}
+
+uint64_t BinaryReader::ReadU64()
+{
+	if (!Require(8))
+	{
+		return 0;
+	}
+
+	uint64_t Value = 0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		Value |= ((uint64_t)(uint8_t)Data[Pos++]) << (8 * i);
+	}
+
+	return Value;
+}
+
+double BinaryReader::ReadDouble()
+{
+	uint64_t Bits = ReadU64();
+	double Value;
+	std::memcpy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+std::string BinaryReader::ReadString()
+{
+	uint32_t Length = ReadU32();
+
+	if (!Require(Length))
+	{
+		return "";
+	}
+
+	std::string Str = Data.substr(Pos, Length).str();
+	Pos += Length;
+	return Str;
+}
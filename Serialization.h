@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "llvm/ADT/StringRef.h"
+
+
+
+/**
+ * The BinaryWriter appends fixed width little endian integers and length prefixed strings to a byte buffer.
+ * It is used for the files the tool writes to disk, e.g. the entries of the AnalysisCache or a GraphSnapshot.
+ */
+class BinaryWriter
+{
+public:
+	BinaryWriter();
+
+	void WriteU8(uint8_t Value);
+
+	void WriteU32(uint32_t Value);
+
+	void WriteU64(uint64_t Value);
+
+	void WriteBool(bool Value) { WriteU8(Value ? 1 : 0); }
+
+	void WriteDouble(double Value);
+
+	void WriteString(llvm::StringRef Str);
+
+	std::string& GetBuffer() { return Buffer; }
+
+	/**
+	 * @brief Writes the buffer to a temporary file next to the target and renames it afterwards.
+	 * Readers (also from other processes) therefore never see a partially written file.
+	 *
+	 * @param Path The target file.
+	 *
+	 * @return True on success.
+	 **/
+	bool WriteToFile(llvm::StringRef Path);
+
+private:
+	std::string Buffer;
+};
+
+/**
+ * The BinaryReader reads the values written by a BinaryWriter in the same order.
+ * Reading past the end of the data does not crash, but sets the reader into a failed state and returns zero values.
+ * Check HasFailed() after reading a complete record.
+ */
+class BinaryReader
+{
+public:
+	BinaryReader(llvm::StringRef Data);
+
+	uint8_t ReadU8();
+
+	uint32_t ReadU32();
+
+	uint64_t ReadU64();
+
+	bool ReadBool() { return ReadU8() != 0; }
+
+	double ReadDouble();
+
+	std::string ReadString();
+
+	bool HasFailed() { return Failed; }
+
+	bool AtEnd() { return Pos == Data.size(); }
+
+private:
+	bool Require(size_t NumBytes);
+
+	llvm::StringRef Data;
+
+	size_t Pos = 0;
+
+	bool Failed = false;
+};
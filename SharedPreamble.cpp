@@ -0,0 +1,259 @@
+#include "SharedPreamble.h"
+
+#include <algorithm>
+#include <chrono>
+#include "clang/Basic/DiagnosticFrontend.h"
+#include "clang/Basic/DiagnosticIDs.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Frontend/ChainedDiagnosticConsumer.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+
+
+/**
+ * Generates the precompiled header and records the files it is built from.
+ */
+class BuildPreambleAction : public clang::GeneratePCHAction
+{
+public:
+	BuildPreambleAction(std::string OutputFile, std::vector<std::string>& Dependencies) : OutputFile(OutputFile), Dependencies(Dependencies)
+	{
+	}
+
+protected:
+	bool BeginInvocation(clang::CompilerInstance& CI) override
+	{
+		/* The compile command is adjusted for -fsyntax-only, so there is no output file on the command line */
+		CI.getFrontendOpts().OutputFile = OutputFile;
+		return clang::GeneratePCHAction::BeginInvocation(CI);
+	}
+
+	void EndSourceFileAction() override
+	{
+		clang::SourceManager& SourceMan = getCompilerInstance().getSourceManager();
+		for (auto File = SourceMan.fileinfo_begin(); File != SourceMan.fileinfo_end(); File++)
+		{
+			llvm::SmallString<256> Path(File->first->getName());
+			SourceMan.getFileManager().makeAbsolutePath(Path);
+			Dependencies.push_back(Path.str().str());
+		}
+
+		clang::GeneratePCHAction::EndSourceFileAction();
+	}
+
+private:
+	std::string OutputFile;
+
+	std::vector<std::string>& Dependencies;
+};
+
+
+
+/* Set by the PCHRejectionDetector of the translation unit parsed on this thread */
+static thread_local bool PCHRejected = false;
+
+/**
+ * Records the errors which mean that clang rejected the precompiled header. The diagnostics are printed by the original consumer.
+ */
+class PCHRejectionDetector : public clang::DiagnosticConsumer
+{
+public:
+	void HandleDiagnostic(clang::DiagnosticsEngine::Level Level, const clang::Diagnostic& Info) override
+	{
+		/* The AST reader reports a modified header, different options or a broken file with the diagnostics of the serialization component */
+		unsigned int ID = Info.getID();
+		bool IsSerializationError = ID >= clang::diag::DIAG_START_SERIALIZATION && ID < clang::diag::DIAG_START_LEX;
+
+		if (Level >= clang::DiagnosticsEngine::Error && (IsSerializationError || ID == clang::diag::err_fe_unable_to_load_pch))
+		{
+			PCHRejected = true;
+		}
+	}
+};
+
+
+
+SharedPreamble::SharedPreamble(std::vector<std::string> Headers) : NumUsed(0), NumNotUsed(0)
+{
+	this->Headers = Headers;
+}
+
+SharedPreamble::~SharedPreamble()
+{
+	if (!HeaderPath.empty())
+	{
+		llvm::sys::fs::remove(HeaderPath);
+	}
+
+	if (!PCHPath.empty())
+	{
+		llvm::sys::fs::remove(PCHPath);
+	}
+}
+
+bool SharedPreamble::Build(const clang::tooling::CompilationDatabase& Compilations, const std::vector<std::string>& Files, clang::tooling::ArgumentsAdjuster ArgsAdjuster)
+{
+	if (Headers.empty() || Files.empty())
+	{
+		return false;
+	}
+
+	std::vector<clang::tooling::CompileCommand> Commands = Compilations.getCompileCommands(Files[0]);
+
+	if (Commands.empty())
+	{
+		return false;
+	}
+
+	clang::tooling::CompileCommand& Command = Commands[0];
+
+	/* The header which includes all common headers */
+	llvm::SmallString<256> TempPath;
+	int FD;
+
+	if (llvm::sys::fs::createTemporaryFile("pint-preamble", "h", FD, TempPath))
+	{
+		return false;
+	}
+
+	HeaderPath = TempPath.str().str();
+
+	{
+		llvm::raw_fd_ostream Out(FD, true);
+
+		for (std::string& Header : Headers)
+		{
+			if (llvm::StringRef(Header).startswith("<"))
+			{
+				Out << "#include " << Header << "\n";
+			}
+			else
+			{
+				/* Relative paths are relative to the directory of the compile command, like the include paths */
+				llvm::SmallString<256> AbsoluteHeader(Header);
+				if (!llvm::sys::path::is_absolute(AbsoluteHeader))
+				{
+					AbsoluteHeader = Command.Directory;
+					llvm::sys::path::append(AbsoluteHeader, Header);
+				}
+				Out << "#include \"" << AbsoluteHeader << "\"\n";
+			}
+		}
+	}
+
+	if (llvm::sys::fs::createTemporaryFile("pint-preamble", "pch", TempPath))
+	{
+		return false;
+	}
+
+	PCHPath = TempPath.str().str();
+
+	/* Use the compile command of the file, but with the header as input */
+	clang::tooling::CommandLineArguments CommandLine = Command.CommandLine;
+	CommandLine = clang::tooling::getClangStripOutputAdjuster()(CommandLine, Command.Filename);
+	CommandLine = clang::tooling::getClangSyntaxOnlyAdjuster()(CommandLine, Command.Filename);
+	if (ArgsAdjuster)
+	{
+		CommandLine = ArgsAdjuster(CommandLine, Command.Filename);
+	}
+
+	size_t NumArgs = CommandLine.size();
+	CommandLine.erase(std::remove(CommandLine.begin(), CommandLine.end(), Command.Filename), CommandLine.end());
+
+	if (CommandLine.size() == NumArgs)
+	{
+		llvm::errs() << "Preamble: the source file is not found in the compile command of " << Command.Filename << "\n";
+		return false;
+	}
+
+	CommandLine.push_back("-x");
+	CommandLine.push_back(llvm::sys::path::extension(Command.Filename) == ".c" ? "c-header" : "c++-header");
+	CommandLine.push_back(HeaderPath);
+
+	llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FileSystem = llvm::vfs::createPhysicalFileSystem().release();
+	FileSystem->setCurrentWorkingDirectory(Command.Directory);
+	llvm::IntrusiveRefCntPtr<clang::FileManager> FileMan(new clang::FileManager(clang::FileSystemOptions(), FileSystem));
+
+	std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+	clang::tooling::ToolInvocation Invocation(CommandLine, std::make_unique<BuildPreambleAction>(PCHPath, Dependencies), FileMan.get(), std::make_shared<clang::PCHContainerOperations>());
+
+	if (!Invocation.run())
+	{
+		llvm::errs() << "Preamble: the common headers could not be precompiled, all files are parsed without them\n";
+		return false;
+	}
+
+	BuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+
+	/* The generated header is not a real dependency */
+	Dependencies.erase(std::remove(Dependencies.begin(), Dependencies.end(), HeaderPath), Dependencies.end());
+
+	return true;
+}
+
+clang::tooling::ArgumentsAdjuster SharedPreamble::GetArgumentsAdjuster()
+{
+	clang::tooling::CommandLineArguments Arguments;
+	Arguments.push_back("-include-pch");
+	Arguments.push_back(PCHPath);
+
+	return clang::tooling::getInsertArgumentAdjuster(Arguments, clang::tooling::ArgumentInsertPosition::END);
+}
+
+void SharedPreamble::DetectRejection(clang::CompilerInstance& Compiler)
+{
+	PCHRejected = false;
+
+	clang::DiagnosticsEngine& Diagnostics = Compiler.getDiagnostics();
+	std::unique_ptr<clang::DiagnosticConsumer> Detector(new PCHRejectionDetector());
+
+	/* The chained consumer takes over the original consumer only if the diagnostics engine owned it */
+	if (Diagnostics.ownsClient())
+	{
+		Diagnostics.setClient(new clang::ChainedDiagnosticConsumer(Diagnostics.takeClient(), std::move(Detector)));
+	}
+	else
+	{
+		Diagnostics.setClient(new clang::ChainedDiagnosticConsumer(std::move(Detector), Diagnostics.getClient()));
+	}
+}
+
+bool SharedPreamble::WasRejected()
+{
+	bool Rejected = PCHRejected;
+	PCHRejected = false;
+	return Rejected;
+}
+
+void SharedPreamble::CountTranslationUnit(bool UsedPreamble)
+{
+	if (UsedPreamble)
+	{
+		NumUsed++;
+	}
+	else
+	{
+		NumNotUsed++;
+	}
+}
+
+void SharedPreamble::PrintSummary()
+{
+	llvm::errs() << "Preamble: " << Headers.size() << " headers precompiled in " << llvm::format("%.1f", BuildTime) << " ms, used by " << NumUsed << " translation units, " << NumNotUsed << " parsed without it\n";
+
+	/* Building the precompiled header takes about as long as parsing the headers once */
+	if (NumUsed > 1)
+	{
+		llvm::errs() << "Preamble: about " << llvm::format("%.1f", (NumUsed - 1) * BuildTime / 1000) << " s of parsing saved\n";
+	}
+}
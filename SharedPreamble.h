@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Frontend/CompilerInstance.h"
+
+
+
+/**
+ * The SharedPreamble precompiles a set of common headers (e.g. PatternInstrumentation.h and the heavy headers of a project) once per run.
+ * Every translation unit is then parsed with -include-pch, so the headers are not lexed and analysed again for each file.
+ * The precompiled header is built with the compile command of the first file, so it can only be used by files with compatible compile options.
+ * Files for which clang rejects the precompiled header are parsed again without it (see RunParallelAnalysis() and DetectRejection()).
+ */
+class SharedPreamble
+{
+public:
+	/**
+	 * @param Headers The headers to precompile. Paths are included with quotes, names in angle brackets (e.g. <string>) as they are.
+	 **/
+	SharedPreamble(std::vector<std::string> Headers);
+
+	/**
+	 * @brief Removes the temporary files.
+	 **/
+	~SharedPreamble();
+
+	/**
+	 * @brief Builds the precompiled header with the first compile command of the first file.
+	 *
+	 * @param Compilations The compilation database.
+	 * @param Files The source files which are analysed.
+	 * @param ArgsAdjuster The arguments adjuster of the analysis, it has to be applied to the precompiled header as well.
+	 *
+	 * @return False if the precompiled header could not be built. Then it must not be used.
+	 **/
+	bool Build(const clang::tooling::CompilationDatabase& Compilations, const std::vector<std::string>& Files, clang::tooling::ArgumentsAdjuster ArgsAdjuster);
+
+	/**
+	 * @brief Returns an arguments adjuster which adds the precompiled header to a compile command.
+	 **/
+	clang::tooling::ArgumentsAdjuster GetArgumentsAdjuster();
+
+	/**
+	 * @brief Returns the absolute paths of all files the precompiled header was built from, they are dependencies of every translation unit using it.
+	 **/
+	const std::vector<std::string>& GetDependencies() { return Dependencies; }
+
+	/**
+	 * @brief Watches the diagnostics of a compiler instance for the errors clang reports if it rejects a precompiled header,
+	 * e.g. because a header was modified or the language options differ. All diagnostics are still printed as usual.
+	 * Has to be called before the source file is processed, i.e. in FrontendAction::BeginInvocation().
+	 *
+	 * @param Compiler The compiler instance of the translation unit.
+	 **/
+	static void DetectRejection(clang::CompilerInstance& Compiler);
+
+	/**
+	 * @brief Tells whether clang rejected the precompiled header in the last translation unit watched by DetectRejection() on this thread, and resets the result.
+	 * Other errors, e.g. in the source file, do not count.
+	 *
+	 * @return True if the precompiled header was rejected.
+	 **/
+	static bool WasRejected();
+
+	/**
+	 * @brief Counts a translation unit parsed with or without the precompiled header for the summary.
+	 **/
+	void CountTranslationUnit(bool UsedPreamble);
+
+	/**
+	 * @brief Prints the number of headers, the build time and the number of translation units which used the precompiled header to stderr.
+	 * The time saved is estimated with the build time, since the parse time of the headers without the precompiled header is not known.
+	 **/
+	void PrintSummary();
+
+private:
+	std::vector<std::string> Headers;
+
+	std::string HeaderPath;
+
+	std::string PCHPath;
+
+	std::vector<std::string> Dependencies;
+
+	double BuildTime = 0;
+
+	/* Atomic, because the preamble is shared by the worker threads */
+	std::atomic<unsigned int> NumUsed;
+
+	std::atomic<unsigned int> NumNotUsed;
+};
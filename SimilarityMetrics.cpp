@@ -5,12 +5,14 @@
 /**
  * @brief Constructor for the abstract similarity measure class.
  *
+ * @param Graph The graph of the patterns.
  * @param RootPattern The pattern from which the pattern sequences are constructed.
  * @param maxlength The maximum sequence length.
  * @param dir The direction (children/parents) in which the sequences are extracted.
  **/
-SimilarityMeasure::SimilarityMeasure(std::vector<HPCParallelPattern*> RootPatterns, int maxlength, GraphSearchDirection dir)
+SimilarityMeasure::SimilarityMeasure(PatternGraph* Graph, std::vector<HPCParallelPattern*> RootPatterns, int maxlength, GraphSearchDirection dir)
 {
+	this->Graph = Graph;
 	this->RootPatterns = RootPatterns;
 	this->maxlength = maxlength;
 	this->dir = dir;
@@ -57,22 +59,25 @@ std::vector<SimilarityMeasure::PatternSequence*> SimilarityMeasure::FindPatternS
 	CurSeq = new PatternSequence;
 	CurSeq->Patterns.push_back(PatternNode->GetPatternOccurrence()->GetPattern());
 
-	std::vector<PatternGraphNode*> Neighbours;
+	const FrozenPatternGraph* Frozen = Graph->GetFrozenGraph();
+	FrozenPatternGraph::NodeID Start = Frozen->GetNodeID(PatternNode);
+
+	llvm::ArrayRef<FrozenPatternGraph::NodeID> Neighbours;
 
 	/* determine the direction in which to build the sequences */
 	if (dir ==  DIR_Children)
 	{
-		Neighbours = PatternNode->GetChildren();
+		Neighbours = Frozen->GetChildren(Start);
 	}
 	else
 	{
-		Neighbours = PatternNode->GetParents();
+		Neighbours = Frozen->GetParents(Start);
 	}
 
 	/* Start with visiting the neighbours */
-	for (PatternGraphNode* Neighbour : Neighbours)
+	for (FrozenPatternGraph::NodeID Neighbour : Neighbours)
 	{
-		VisitPatternGraphNode(Neighbour, CurSeq, &Seqs, dir, 1, maxdepth);
+		VisitPatternGraphNode(Frozen, Neighbour, CurSeq, &Seqs, dir, 1, maxdepth);
 	}
 
 	return Seqs;
@@ -81,21 +86,22 @@ std::vector<SimilarityMeasure::PatternSequence*> SimilarityMeasure::FindPatternS
 /**
  * @brief Recursive function for extraction of the pattern sequences.
  *
- * @param CurrentNode The current pattern tree node.
+ * @param Graph The frozen pattern graph.
+ * @param CurrentNode The ID of the current pattern tree node.
  * @param CurrentSequence The current pattern sequence to which we add further patterns.
  * @param Sequences A pointer to a vector of sequences to which new sequences are added.
  * @param dir Direction of recursive descent.
  * @param depth The current recursion depth.
  * @param maxdepth The maximum recursion depth.
  **/
-void SimilarityMeasure::VisitPatternGraphNode(PatternGraphNode* CurrentNode, PatternSequence* CurrentSequence, std::vector<PatternSequence*>* Sequences, GraphSearchDirection dir, int depth, int maxdepth)
+void SimilarityMeasure::VisitPatternGraphNode(const FrozenPatternGraph* Graph, FrozenPatternGraph::NodeID CurrentNode, PatternSequence* CurrentSequence, std::vector<PatternSequence*>* Sequences, GraphSearchDirection dir, int depth, int maxdepth)
 {
 	/* Check if the current node is a pattern occurrence node */
-	if (PatternCodeRegion* CurrentCodeReg = clang::dyn_cast<PatternCodeRegion>(CurrentNode))
+	if (HPCParallelPattern* CurrentPattern = Graph->GetPattern(CurrentNode))
 	{
 		/* Branch a new sequence from the previous */
 		PatternSequence* NewSequence = CurrentSequence->Fork();
-		NewSequence->Patterns.push_back(CurrentCodeReg->GetPatternOccurrence()->GetPattern());
+		NewSequence->Patterns.push_back(CurrentPattern);
 		Sequences->push_back(NewSequence);
 
 		CurrentSequence = NewSequence;
@@ -105,21 +111,21 @@ void SimilarityMeasure::VisitPatternGraphNode(PatternGraphNode* CurrentNode, Pat
 	if (CurrentSequence->Patterns.size() < this->maxlength && depth < maxdepth)
 	{
 		/* Get neighbours */
-		std::vector<PatternGraphNode*> Neighbours;
+		llvm::ArrayRef<FrozenPatternGraph::NodeID> Neighbours;
 
 		if (dir == DIR_Children)
 		{
-			Neighbours = CurrentNode->GetChildren();
+			Neighbours = Graph->GetChildren(CurrentNode);
 		}
 		else
 		{
-			Neighbours = CurrentNode->GetParents();
+			Neighbours = Graph->GetParents(CurrentNode);
 		}
 
 		/* Visit Neighbours */
-		for (PatternGraphNode* Neighbour : Neighbours)
+		for (FrozenPatternGraph::NodeID Neighbour : Neighbours)
 		{
-			VisitPatternGraphNode(Neighbour, CurrentSequence, Sequences, dir, depth + 1, maxdepth);
+			VisitPatternGraphNode(Graph, Neighbour, CurrentSequence, Sequences, dir, depth + 1, maxdepth);
 		}
 	}
 }
@@ -154,6 +160,7 @@ std::vector<SimilarityMeasure::PatternSequence*> SimilarityMeasure::FilterSequen
 /**
  * @brief Constructor for the Jaccard similarity statistic.
  *
+ * @param Graph The graph of the patterns.
  * @param RootPattern The root pattern for all pattern sequences.
  * @param minlength The minimum length for a sequence to be considered.
  * @param maxlength The max length of a sequence.
@@ -161,7 +168,7 @@ std::vector<SimilarityMeasure::PatternSequence*> SimilarityMeasure::FilterSequen
  * @param Crit The similarity criterion used.
  * @param outputlen Length of the textual output: how many entries are displayed.
  **/
-JaccardSimilarityStatistic::JaccardSimilarityStatistic(std::vector<HPCParallelPattern*> RootPattern, int minlength, int maxlength, GraphSearchDirection dir, SimilarityCriterion Crit, int outputlen) : SimilarityMeasure(RootPattern, maxlength, dir)
+JaccardSimilarityStatistic::JaccardSimilarityStatistic(PatternGraph* Graph, std::vector<HPCParallelPattern*> RootPattern, int minlength, int maxlength, GraphSearchDirection dir, SimilarityCriterion Crit, int outputlen) : SimilarityMeasure(Graph, RootPattern, maxlength, dir)
 {
 	this->minlength = minlength;
 	this->Crit = Crit;
@@ -2,6 +2,7 @@
 
 #include "HPCPatternStatistics.h"
 #include "HPCParallelPattern.h"
+#include "FrozenPatternGraph.h"
 #include <vector>
 #include <iostream>
 #include <algorithm>
@@ -159,7 +160,7 @@ public:
 
 	static bool CompareBySimilarity(const SimilarityPair* SimPair1, const SimilarityPair* SimPair2);
 
-	SimilarityMeasure(std::vector<HPCParallelPattern*> RootPattern, int maxlength, GraphSearchDirection dir);
+	SimilarityMeasure(PatternGraph* Graph, std::vector<HPCParallelPattern*> RootPattern, int maxlength, GraphSearchDirection dir);
 
 	static void SortBySimilarity(std::vector<SimilarityPair*>& Sims);
 
@@ -172,7 +173,9 @@ protected:
 
 	std::vector<SimilarityPair*> Similarities;
 
-	void VisitPatternGraphNode(PatternGraphNode* CurrentNode, PatternSequence* CurrentSequence, std::vector<PatternSequence*>* Sequences, GraphSearchDirection dir, int depth, int maxdepth);
+	void VisitPatternGraphNode(const FrozenPatternGraph* Graph, FrozenPatternGraph::NodeID CurrentNode, PatternSequence* CurrentSequence, std::vector<PatternSequence*>* Sequences, GraphSearchDirection dir, int depth, int maxdepth);
+
+	PatternGraph* Graph;
 
 	std::vector<HPCParallelPattern*> RootPatterns;
 
@@ -195,7 +198,7 @@ protected:
 class JaccardSimilarityStatistic : public HPCPatternStatistic, public SimilarityMeasure
 {
 public:
-	JaccardSimilarityStatistic(std::vector<HPCParallelPattern*> RootPattern, int minlength, int maxlength, GraphSearchDirection dir, SimilarityCriterion Crit, int outputlen);
+	JaccardSimilarityStatistic(PatternGraph* Graph, std::vector<HPCParallelPattern*> RootPattern, int minlength, int maxlength, GraphSearchDirection dir, SimilarityCriterion Crit, int outputlen);
 
 	void Calculate();
 
@@ -0,0 +1,21 @@
+#include "SourcePosition.h"
+
+
+
+void SourcePosition::Serialize(BinaryWriter& Writer) const
+{
+	Writer.WriteString(AtomTable::GetString(File));
+	Writer.WriteU32(Line);
+	Writer.WriteU32(Column);
+	Writer.WriteU32(Offset);
+}
+
+SourcePosition SourcePosition::Deserialize(BinaryReader& Reader)
+{
+	SourcePosition Pos;
+	Pos.File = AtomTable::Intern(Reader.ReadString());
+	Pos.Line = Reader.ReadU32();
+	Pos.Column = Reader.ReadU32();
+	Pos.Offset = Reader.ReadU32();
+	return Pos;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "AtomTable.h"
+#include "Serialization.h"
+
+
+
+/**
+ * A SourcePosition is the file, line, column and byte offset of a clang::SourceLocation.
+ * Unlike a SourceLocation it does not depend on the SourceManager of the translation unit, so it stays valid after the AST has been released and can be cached or written to a GraphSnapshot.
+ * The visitor resolves the positions during the traversal, locations within macros are resolved to their expansion.
+ */
+struct SourcePosition
+{
+	/* The interned path of the file, 0 if the position is unknown */
+	Atom File = 0;
+	unsigned Line = 0;
+	unsigned Column = 0;
+	/* The offset in bytes from the beginning of the file */
+	unsigned Offset = 0;
+
+	bool IsValid() const { return File != 0; }
+
+	/**
+	 * @brief Writes the position, the file is written as a string.
+	 **/
+	void Serialize(BinaryWriter& Writer) const;
+
+	/**
+	 * @brief Reads a position written by Serialize() and interns its file.
+	 **/
+	static SourcePosition Deserialize(BinaryReader& Reader);
+};
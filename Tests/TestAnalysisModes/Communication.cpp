@@ -0,0 +1,9 @@
+#include "Communication.h"
+#include "PatternInstrumentation.h"
+
+void Exchange()
+{
+	PatternInstrumentation::Pattern_Begin("ImplementationMechanism Communication CO1");
+	int Halo = 0;
+	PatternInstrumentation::Pattern_End("CO1");
+}
@@ -0,0 +1,13 @@
+#include "Reduction.h"
+#include "PatternInstrumentation.h"
+
+double Reduce()
+{
+	double Sum = 0;
+
+	PatternInstrumentation::Pattern_Begin("SupportingStructure Reduction RE1");
+	Sum += 1;
+	PatternInstrumentation::Pattern_End("RE1");
+
+	return Sum;
+}
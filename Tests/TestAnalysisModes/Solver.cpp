@@ -0,0 +1,18 @@
+#include "Solver.h"
+#include "Communication.h"
+#include "Reduction.h"
+#include "PatternInstrumentation.h"
+
+void Solve(int Iterations)
+{
+	PatternInstrumentation::Pattern_Begin("AlgorithmStructure GeometricDecomposition GD1");
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		Exchange();
+	}
+
+	PatternInstrumentation::Pattern_End("GD1");
+
+	Reduce();
+}
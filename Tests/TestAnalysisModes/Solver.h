@@ -0,0 +1,3 @@
+#pragma once
+
+void Solve(int Iterations);
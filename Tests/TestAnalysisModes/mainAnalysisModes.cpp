@@ -0,0 +1,16 @@
+#include "PatternInstrumentation.h"
+#include "Solver.h"
+#include "Communication.h"
+
+
+int main(int argc, char* argv[])
+{
+	PatternInstrumentation::Pattern_Begin("FindingConcurrency TaskDecomposition TD1");
+
+	Solve(10);
+
+	PatternInstrumentation::Pattern_End("TD1");
+
+	Exchange();
+	return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+/* Declared here, defined in different files */
+void ExchangeHalo(int Width);
+
+void Scale(int Factor);
+
+void Scale(double Factor);
+
+namespace Grid
+{
+	void Update();
+}
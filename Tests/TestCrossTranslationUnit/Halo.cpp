@@ -0,0 +1,16 @@
+#include "PatternInstrumentation.h"
+#include "Grid.h"
+
+void ExchangeHalo(int Width)
+{
+	PatternInstrumentation::Pattern_Begin("ImplementationMechanism MessagePassing MP1");
+	int Sent = Width;
+	PatternInstrumentation::Pattern_End("MP1");
+}
+
+void Scale(int Factor)
+{
+	PatternInstrumentation::Pattern_Begin("AlgorithmStructure Geometric GD1");
+	int Value = Factor;
+	PatternInstrumentation::Pattern_End("GD1");
+}
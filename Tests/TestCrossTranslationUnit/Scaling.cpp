@@ -0,0 +1,17 @@
+#include "PatternInstrumentation.h"
+#include "Grid.h"
+
+void Scale(double Factor)
+{
+	PatternInstrumentation::Pattern_Begin("AlgorithmStructure Geometric GD2");
+	double Value = Factor;
+	PatternInstrumentation::Pattern_End("GD2");
+}
+
+namespace Grid
+{
+	void Update()
+	{
+		ExchangeHalo(2);
+	}
+}
@@ -0,0 +1,16 @@
+#include "PatternInstrumentation.h"
+#include "Grid.h"
+
+
+int main(int argc, char* argv[])
+{
+	PatternInstrumentation::Pattern_Begin("SupportingStructure SPMD SP1");
+
+	ExchangeHalo(1);
+	Scale(2);
+	Scale(0.5);
+	Grid::Update();
+
+	PatternInstrumentation::Pattern_End("SP1");
+	return 0;
+}
@@ -0,0 +1,29 @@
+#include "PatternInstrumentation.h"
+
+/* The prototype and the definition are two declarations with the same hash in the call tree */
+int Fibonacci(int N);
+
+
+int main(int argc, char* argv[])
+{
+	PatternInstrumentation::Pattern_Begin("AlgorithmStructure DivideAndConquer DC1");
+
+	int Result = Fibonacci(10);
+
+	PatternInstrumentation::Pattern_End("DC1");
+	return 0;
+}
+
+int Fibonacci(int N)
+{
+	PatternInstrumentation::Pattern_Begin("ImplementationMechanism Recursion RC1");
+
+	int Result = N;
+	if (N > 1)
+	{
+		Result = Fibonacci(N - 1) + Fibonacci(N - 2);
+	}
+
+	PatternInstrumentation::Pattern_End("RC1");
+	return Result;
+}
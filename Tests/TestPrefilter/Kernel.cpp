@@ -0,0 +1,15 @@
+#include "Kernel.h"
+#include "PatternInstrumentation.h"
+
+void Compute(int Step)
+{
+	PatternInstrumentation::Pattern_Begin("ImplementationMechanism Kernel KE1");
+	int Value = Step * 2;
+	PatternInstrumentation::Pattern_End("KE1");
+}
+
+void Synchronize()
+{
+	PatternInstrumentation::Pattern_Begin("ImplementationMechanism Synchronization SY1");
+	PatternInstrumentation::Pattern_End("SY1");
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+void Compute(int Step);
+
+void Synchronize();
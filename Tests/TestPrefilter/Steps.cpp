@@ -0,0 +1,19 @@
+/* This file contains no instrumentation calls, so it is only searched for calls with -prefilter.
+   The calls link the pattern in main to the patterns in Kernel.cpp. */
+#include "Steps.h"
+#include "Kernel.h"
+
+void RunSteps(int NumSteps)
+{
+	for (int i = 0; i < NumSteps; i++)
+	{
+		Compute(i);
+	}
+
+	WriteResults();
+}
+
+void WriteResults()
+{
+	Synchronize();
+}
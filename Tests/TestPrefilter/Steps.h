@@ -0,0 +1,5 @@
+#pragma once
+
+void RunSteps(int NumSteps);
+
+void WriteResults();
@@ -0,0 +1,13 @@
+#include "PatternInstrumentation.h"
+#include "Steps.h"
+
+
+int main(int argc, char* argv[])
+{
+	PatternInstrumentation::Pattern_Begin("AlgorithmStructure TaskParallelism TP1");
+
+	RunSteps(argc);
+
+	PatternInstrumentation::Pattern_End("TP1");
+	return 0;
+}
@@ -0,0 +1,123 @@
+#!/bin/sh
+# Runs the tool on a test project without options and in several analysis modes.
+# Every mode has to print the same as the run without options, which is compared with desiredOutput.txt of the project.
+# The order of the statistics follows the order of the files in compile_commands.json.
+#
+# Usage: Tests/compareModes.sh /path/to/HPC-pattern-tool Tests/TestAnalysisModes
+
+if [ $# -ne 2 ]; then
+	echo "Usage: $0 /path/to/HPC-pattern-tool /path/to/test/project"
+	exit 2
+fi
+
+TOOL=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+TESTDIR=$(cd "$2" && pwd)
+WORKDIR=$(mktemp -d)
+ESC=$(printf '\033')
+FAILED=0
+
+cd "$WORKDIR" || exit 2
+mkdir build
+(cd build && cmake "$TESTDIR" > ../cmake.log 2>&1) || { cat cmake.log; exit 2; }
+
+# Runs the tool with the given arguments, the output is written to <name>.txt without color codes
+run()
+{
+	NAME=$1
+	shift
+	"$TOOL" "$@" 2> "$NAME.err" | sed "s/$ESC\[[0-9;]*m//g" > "$NAME.txt"
+}
+
+# Compares the output of a mode with the output of the run without options
+check()
+{
+	if diff plain.txt "$1.txt" > "$1.diff"; then
+		echo "$1: OK"
+	else
+		echo "$1: FAILED, see $WORKDIR/$1.diff"
+		FAILED=1
+	fi
+}
+
+run plain build/
+if diff "$TESTDIR/desiredOutput.txt" plain.txt > plain.diff; then
+	echo "plain: OK"
+else
+	echo "plain: FAILED, see $WORKDIR/plain.diff"
+	FAILED=1
+fi
+
+run j4 build/ -j 4
+check j4
+
+# The fragments of the workers are merged pairwise, with an odd number of workers and with more workers than files as well
+run j3 build/ -j 3
+check j3
+run j8 build/ -j 8
+check j8
+
+# Files without instrumentation calls are only searched for declarations and calls, the call tree has to be the same
+run prefilter build/ -prefilter
+check prefilter
+
+# All files are compiled with the same options, so none of them may reject the precompiled header
+run preamble build/ "-preambleHeader=$TESTDIR/PatternInstrumentation.h"
+check preamble
+if ! grep -q " 0 parsed without it" preamble.err; then
+	echo "preamble: FAILED, the precompiled header was not used by all files"
+	FAILED=1
+fi
+
+# The second run has to load every file from the cache
+run cache build/ -cacheDir=cache
+check cache
+run cached build/ -cacheDir=cache
+check cached
+if ! grep -q " 0 analysed" cached.err; then
+	echo "cached: FAILED, files were analysed again"
+	FAILED=1
+fi
+
+# A run with a different analysis mode must not use the entries of the full analysis
+run cacheprefilter build/ -cacheDir=cache -prefilter
+if grep -q " 0 analysed" cacheprefilter.err; then
+	echo "cacheprefilter: FAILED, the entries of the full analysis were used"
+	FAILED=1
+else
+	echo "cacheprefilter: OK"
+fi
+
+# Every shard writes a fragment, the merged fragments have to give the same output as the analysis of all files at once
+run shard0 build/ --shard=0/2 --emit-fragment=fragment0.pint
+run shard1 build/ --shard=1/2 --emit-fragment=fragment1.pint
+run merge merge fragment0.pint fragment1.pint
+check merge
+
+# Entries which cannot be written are reported, the output stays the same
+mkdir readonlycache
+chmod a-w readonlycache
+run readonlycache build/ -cacheDir=readonlycache
+check readonlycache
+if [ ! -w readonlycache ] && ! grep -q "could not be written" readonlycache.err; then
+	echo "readonlycache: FAILED, the failed writes were not reported"
+	FAILED=1
+fi
+chmod u+w readonlycache
+
+# The call tree is not set up again after --load-graph, so only the output from the call tree on is compared
+run emitgraph build/ --emit-graph=graph.pint
+check emitgraph
+run loadgraph --load-graph=graph.pint
+sed -n '/CALL TREE VISUALISATION/,$p' plain.txt > plaintree.txt
+sed -n '/CALL TREE VISUALISATION/,$p' loadgraph.txt > loadgraphtree.txt
+if diff plaintree.txt loadgraphtree.txt > loadgraph.diff; then
+	echo "loadgraph: OK"
+else
+	echo "loadgraph: FAILED, see $WORKDIR/loadgraph.diff"
+	FAILED=1
+fi
+
+if [ $FAILED -eq 0 ]; then
+	rm -rf "$WORKDIR"
+fi
+exit $FAILED
@@ -0,0 +1,275 @@
+#include "TimeReport.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Process.h"
+
+#include <algorithm>
+#include <ctime>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+
+
+bool TimeReport::Enabled = false;
+
+std::atomic<uint64_t> TimeReport::Counters[TRC_NumCounters];
+
+std::vector<TimeReport::PhaseTimes> TimeReport::Phases;
+
+unsigned TimeReport::CurrentDepth = 0;
+
+std::mutex TimeReport::Lock;
+
+std::vector<TimeReport::TranslationUnitTimes> TimeReport::TranslationUnits;
+
+static const char* CounterNames[TRC_NumCounters] = { "Call expressions", "Registered functions", "Call tree nodes", "Begin/end matches", "Nesting mismatches" };
+
+static const char* CounterKeys[TRC_NumCounters] = { "callExprs", "registeredFunctions", "callTreeNodes", "beginEndMatches", "nestingMismatches" };
+
+
+
+static double SecondsSince(std::chrono::steady_clock::time_point Start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+}
+
+void TimeReport::Enable(bool Enabled)
+{
+	TimeReport::Enabled = Enabled;
+}
+
+double TimeReport::GetProcessCPUTime()
+{
+	llvm::sys::TimePoint<> Elapsed;
+	std::chrono::nanoseconds User, System;
+	llvm::sys::Process::GetTimeUsage(Elapsed, User, System);
+
+	return std::chrono::duration<double>(User + System).count();
+}
+
+double TimeReport::GetThreadCPUTime()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec Time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Time) == 0)
+	{
+		return Time.tv_sec + Time.tv_nsec / 1e9;
+	}
+#endif
+	return 0;
+}
+
+uint64_t TimeReport::GetPeakRSS()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	struct rusage Usage;
+	if (getrusage(RUSAGE_SELF, &Usage) == 0)
+	{
+#ifdef __APPLE__
+		/* Reported in bytes instead of kilobytes */
+		return Usage.ru_maxrss / 1024;
+#else
+		return Usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
+
+
+TimeReport::Phase::Phase(const char* Name)
+{
+	if (!Enabled)
+	{
+		return;
+	}
+
+	/* Phases with the same name and the same parent are summed up */
+	for (unsigned i = 0; i < Phases.size(); i++)
+	{
+		if (Phases[i].Name == Name && Phases[i].Depth == CurrentDepth)
+		{
+			Index = i;
+			break;
+		}
+	}
+
+	if (Index < 0)
+	{
+		Index = Phases.size();
+		Phases.push_back({ Name, CurrentDepth, 0, 0, 0 });
+	}
+
+	CurrentDepth++;
+	WallStart = std::chrono::steady_clock::now();
+	CPUStart = GetProcessCPUTime();
+}
+
+TimeReport::Phase::~Phase()
+{
+	if (Index < 0)
+	{
+		return;
+	}
+
+	PhaseTimes& Times = Phases[Index];
+	Times.Count++;
+	Times.Wall += SecondsSince(WallStart);
+	Times.CPU += GetProcessCPUTime() - CPUStart;
+	CurrentDepth--;
+}
+
+
+
+TimeReport::TranslationUnit::TranslationUnit(std::string File) : File(File)
+{
+	if (!Enabled)
+	{
+		return;
+	}
+
+	WallStart = std::chrono::steady_clock::now();
+	WallParsed = WallStart;
+	CPUStart = GetThreadCPUTime();
+}
+
+void TimeReport::TranslationUnit::ParsingDone()
+{
+	if (Enabled)
+	{
+		WallParsed = std::chrono::steady_clock::now();
+	}
+}
+
+void TimeReport::TranslationUnit::Done()
+{
+	if (!Enabled)
+	{
+		return;
+	}
+
+	TranslationUnitTimes Times;
+	Times.File = File;
+	Times.Parse = std::chrono::duration<double>(WallParsed - WallStart).count();
+	Times.Traverse = SecondsSince(WallParsed);
+	Times.CPU = GetThreadCPUTime() - CPUStart;
+
+	std::lock_guard<std::mutex> Guard(Lock);
+	TranslationUnits.push_back(std::move(Times));
+}
+
+
+
+void TimeReport::Print(llvm::raw_ostream& OS, unsigned MaxTranslationUnits)
+{
+	OS << "\n===== Time Report =====\n\n";
+
+	OS << llvm::formatv("{0,-40} {1,8} {2,12} {3,12}\n", "Phase", "Count", "Wall (s)", "CPU (s)");
+	for (PhaseTimes& Times : Phases)
+	{
+		std::string Name = std::string(2 * Times.Depth, ' ') + Times.Name;
+		OS << llvm::formatv("{0,-40} {1,8} {2,12:F3} {3,12:F3}\n", Name, Times.Count, Times.Wall, Times.CPU);
+	}
+
+	std::vector<TranslationUnitTimes> Slowest;
+	{
+		std::lock_guard<std::mutex> Guard(Lock);
+		Slowest = TranslationUnits;
+	}
+
+	if (!Slowest.empty())
+	{
+		std::stable_sort(Slowest.begin(), Slowest.end(), [](const TranslationUnitTimes& A, const TranslationUnitTimes& B) { return A.Parse + A.Traverse > B.Parse + B.Traverse; });
+
+		double Parse = 0, Traverse = 0, CPU = 0;
+		for (TranslationUnitTimes& Times : Slowest)
+		{
+			Parse += Times.Parse;
+			Traverse += Times.Traverse;
+			CPU += Times.CPU;
+		}
+
+		OS << "\n" << llvm::formatv("{0,-40} {1,12} {2,12} {3,12}\n", "Translation unit", "Parse (s)", "Visitor (s)", "CPU (s)");
+		for (unsigned i = 0; i < Slowest.size() && i < MaxTranslationUnits; i++)
+		{
+			TranslationUnitTimes& Times = Slowest[i];
+			OS << llvm::formatv("{0,-40} {1,12:F3} {2,12:F3} {3,12:F3}\n", Times.File, Times.Parse, Times.Traverse, Times.CPU);
+		}
+		if (Slowest.size() > MaxTranslationUnits)
+		{
+			OS << "(" << Slowest.size() - MaxTranslationUnits << " more translation units)\n";
+		}
+
+		std::string Total = "Total (" + std::to_string(Slowest.size()) + " translation units)";
+		OS << llvm::formatv("{0,-40} {1,12:F3} {2,12:F3} {3,12:F3}\n", Total, Parse, Traverse, CPU);
+	}
+
+	OS << "\n" << llvm::formatv("{0,-40} {1,12}\n", "Counter", "Value");
+	for (unsigned i = 0; i < TRC_NumCounters; i++)
+	{
+		OS << llvm::formatv("{0,-40} {1,12}\n", CounterNames[i], Counters[i].load());
+	}
+	OS << llvm::formatv("{0,-40} {1,12}\n", "Peak resident set size (KiB)", GetPeakRSS());
+}
+
+bool TimeReport::WriteJSON(std::string FileName)
+{
+	std::error_code EC;
+	llvm::raw_fd_ostream File(FileName, EC, llvm::sys::fs::OF_Text);
+
+	if (EC)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> Guard(Lock);
+
+	llvm::json::OStream JSON(File, 2);
+	JSON.object([&]
+	{
+		JSON.attributeArray("phases", [&]
+		{
+			for (PhaseTimes& Times : Phases)
+			{
+				JSON.object([&]
+				{
+					JSON.attribute("name", Times.Name);
+					JSON.attribute("depth", (int64_t)Times.Depth);
+					JSON.attribute("count", (int64_t)Times.Count);
+					JSON.attribute("wall", Times.Wall);
+					JSON.attribute("cpu", Times.CPU);
+				});
+			}
+		});
+
+		JSON.attributeArray("translationUnits", [&]
+		{
+			for (TranslationUnitTimes& Times : TranslationUnits)
+			{
+				JSON.object([&]
+				{
+					JSON.attribute("file", Times.File);
+					JSON.attribute("parse", Times.Parse);
+					JSON.attribute("visitor", Times.Traverse);
+					JSON.attribute("cpu", Times.CPU);
+				});
+			}
+		});
+
+		JSON.attributeObject("counters", [&]
+		{
+			for (unsigned i = 0; i < TRC_NumCounters; i++)
+			{
+				JSON.attribute(CounterKeys[i], (int64_t)Counters[i].load());
+			}
+			JSON.attribute("peakRSSKiB", (int64_t)GetPeakRSS());
+		});
+	});
+	File << "\n";
+
+	return !File.has_error();
+}
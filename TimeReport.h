@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "llvm/Support/raw_ostream.h"
+
+
+
+/**
+ * The counters of the TimeReport.
+ */
+enum TimeReportCounter
+{
+	TRC_CallExprs, /*!< Call expressions visited in the main files. */
+	TRC_RegisteredFunctions, /*!< FunctionNodes registered in the PatternGraph. */
+	TRC_CallTreeNodes, /*!< CallTreeNodes created, one for every function declaration, call, Pattern_Begin and Pattern_End in the main files (or loaded with --load-graph). CallTree::appendAllDeclToCallTree() only links the existing nodes. */
+	TRC_PatternMatches, /*!< Pattern_Ends matched to their Pattern_Begin by CallTree::setUpTree(). */
+	TRC_NestingMismatches, /*!< Pattern_Begins skipped while matching, because the code regions are not clearly nested. */
+	TRC_NumCounters
+};
+
+/**
+ * The TimeReport measures the wall and CPU time of the phases of a run and of every translation unit and counts some events of the analysis (see -time-report).
+ * It is global for the process, since the translation units are analysed on worker threads which do not know about each other.
+ * If it is not enabled, the phases are not measured and the counters are not incremented.
+ */
+class TimeReport
+{
+public:
+	static void Enable(bool Enabled);
+
+	static bool IsEnabled() { return Enabled; }
+
+	/**
+	 * @brief Measures the time from its construction to its destruction as a phase of the run.
+	 * Phases with the same name are summed up. Phases which are started within another phase are printed below it.
+	 * Phases are only measured on the main thread.
+	 */
+	class Phase
+	{
+	public:
+		explicit Phase(const char* Name);
+
+		~Phase();
+
+	private:
+		int Index = -1;
+		std::chrono::steady_clock::time_point WallStart;
+		double CPUStart = 0;
+	};
+
+	/**
+	 * @brief Measures the time spent on one translation unit on the calling thread.
+	 */
+	class TranslationUnit
+	{
+	public:
+		explicit TranslationUnit(std::string File);
+
+		/**
+		 * @brief Marks the end of parsing and the begin of the traversal of the AST.
+		 **/
+		void ParsingDone();
+
+		/**
+		 * @brief Records the times of the translation unit.
+		 **/
+		void Done();
+
+	private:
+		std::string File;
+		std::chrono::steady_clock::time_point WallStart;
+		std::chrono::steady_clock::time_point WallParsed;
+		double CPUStart = 0;
+	};
+
+	static void Count(TimeReportCounter Counter, uint64_t Num = 1)
+	{
+		if (Enabled)
+		{
+			Counters[Counter] += Num;
+		}
+	}
+
+	/**
+	 * @brief Prints the phases, the slowest translation units, the counters and the peak memory usage as tables.
+	 *
+	 * @param OS The stream, usually stderr.
+	 * @param MaxTranslationUnits The maximal number of translation units printed.
+	 **/
+	static void Print(llvm::raw_ostream& OS, unsigned MaxTranslationUnits = 10);
+
+	/**
+	 * @brief Writes the complete report, including all translation units, as JSON.
+	 *
+	 * @param FileName The file name.
+	 *
+	 * @return False if the file cannot be written.
+	 **/
+	static bool WriteJSON(std::string FileName);
+
+private:
+	struct PhaseTimes
+	{
+		std::string Name;
+		unsigned Depth;
+		unsigned Count;
+		double Wall;
+		double CPU;
+	};
+
+	struct TranslationUnitTimes
+	{
+		std::string File;
+		double Parse;
+		double Traverse;
+		double CPU;
+	};
+
+	/* The CPU time of the process, which includes the worker threads */
+	static double GetProcessCPUTime();
+
+	/* The CPU time of the calling thread */
+	static double GetThreadCPUTime();
+
+	/* The maximal resident set size in kilobytes */
+	static uint64_t GetPeakRSS();
+
+	static bool Enabled;
+
+	static std::atomic<uint64_t> Counters[TRC_NumCounters];
+
+	static std::vector<PhaseTimes> Phases;
+
+	static unsigned CurrentDepth;
+
+	/* Guards TranslationUnits, which is written by the worker threads */
+	static std::mutex Lock;
+
+	static std::vector<TranslationUnitTimes> TranslationUnits;
+};
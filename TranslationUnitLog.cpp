@@ -0,0 +1,353 @@
+#include "TranslationUnitLog.h"
+#include "HPCPatternInstrHandler.h"
+#include "HPCParallelPattern.h"
+#include "HPCPatternStatistics.h"
+
+#include <iostream>
+
+#ifndef HPCERROR_H
+#include "HPCError.h"
+#endif
+
+static thread_local std::vector<TranslationUnitLog>* ThreadSink = NULL;
+
+TranslationUnitLog::TranslationUnitLog(std::string SourceFile) : Events()
+{
+	this->SourceFile = SourceFile;
+}
+
+void TranslationUnitLog::AddFunctionDecl(std::string Name, uint64_t Hash, Atom USR, bool IsMain, SourcePosition Pos)
+{
+	TUEvent Event;
+	Event.Kind = TUE_FunctionDecl;
+	Event.Name = Name;
+	Event.Hash = Hash;
+	Event.USR = USR;
+	Event.IsMain = IsMain;
+	Event.Pos = Pos;
+	Events.push_back(Event);
+	LastVisitedIsPatternBegin = false;
+}
+
+void TranslationUnitLog::AddForeignFunctionDecl()
+{
+	/* A foreign declaration only makes a difference if the last visited node is a pattern begin, the headers contain plenty of them */
+	if (!LastVisitedIsPatternBegin)
+	{
+		return;
+	}
+
+	TUEvent Event;
+	Event.Kind = TUE_ForeignFunctionDecl;
+	Events.push_back(Event);
+	LastVisitedIsPatternBegin = false;
+}
+
+void TranslationUnitLog::AddFunctionCall(std::string Name, uint64_t Hash, Atom USR, bool IsMain, SourcePosition Pos)
+{
+	TUEvent Event;
+	Event.Kind = TUE_FunctionCall;
+	Event.Name = Name;
+	Event.Hash = Hash;
+	Event.USR = USR;
+	Event.IsMain = IsMain;
+	Event.Pos = Pos;
+	Events.push_back(Event);
+}
+
+void TranslationUnitLog::AddPatternBegin(bool HasArgument, std::string Argument, SourcePosition Pos)
+{
+	TUEvent Event;
+	Event.Kind = TUE_PatternBegin;
+	Event.HasArgument = HasArgument;
+	Event.Name = Argument;
+	Event.Pos = Pos;
+	Events.push_back(Event);
+	LastVisitedIsPatternBegin = true;
+}
+
+void TranslationUnitLog::AddPatternEnd(bool HasArgument, std::string Argument, SourcePosition Pos)
+{
+	TUEvent Event;
+	Event.Kind = TUE_PatternEnd;
+	Event.HasArgument = HasArgument;
+	Event.Name = Argument;
+	Event.Pos = Pos;
+	Events.push_back(Event);
+}
+
+void TranslationUnitLog::AddHalsteadOperators(unsigned Region, int NumOperators)
+{
+	TUEvent Event;
+	Event.Kind = TUE_HalsteadOperators;
+	Event.Region = Region;
+	Event.NumOperators = NumOperators;
+	Events.push_back(Event);
+}
+
+void TranslationUnitLog::AddDependency(std::string Path)
+{
+	Dependencies.push_back(Path);
+}
+
+void TranslationUnitLog::SetThreadSink(std::vector<TranslationUnitLog>* Sink)
+{
+	ThreadSink = Sink;
+}
+
+std::vector<TranslationUnitLog>* TranslationUnitLog::GetThreadSink()
+{
+	return ThreadSink;
+}
+
+void TranslationUnitLog::Serialize(BinaryWriter& Writer)
+{
+	Writer.WriteString(SourceFile);
+
+	Writer.WriteU32(Dependencies.size());
+	for (std::string& Dependency : Dependencies)
+	{
+		Writer.WriteString(Dependency);
+	}
+
+	Writer.WriteU32(Events.size());
+	for (TUEvent& Event : Events)
+	{
+		Writer.WriteU8(Event.Kind);
+		Writer.WriteString(Event.Name);
+		Writer.WriteU64(Event.Hash);
+		Writer.WriteString(AtomTable::GetString(Event.USR));
+		Writer.WriteBool(Event.IsMain);
+		Writer.WriteBool(Event.HasArgument);
+		Event.Pos.Serialize(Writer);
+		Writer.WriteU32(Event.NumOperators);
+		Writer.WriteU32(Event.Region);
+	}
+}
+
+bool TranslationUnitLog::Deserialize(BinaryReader& Reader, TranslationUnitLog& Log)
+{
+	Log.SourceFile = Reader.ReadString();
+
+	uint32_t NumDependencies = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumDependencies && !Reader.HasFailed(); i++)
+	{
+		Log.Dependencies.push_back(Reader.ReadString());
+	}
+
+	uint32_t NumEvents = Reader.ReadU32();
+	for (uint32_t i = 0; i < NumEvents && !Reader.HasFailed(); i++)
+	{
+		TUEvent Event;
+		uint8_t Kind = Reader.ReadU8();
+		if (Kind > TUE_HalsteadOperators)
+		{
+			return false;
+		}
+		Event.Kind = (TUEventKind)Kind;
+		Event.Name = Reader.ReadString();
+		Event.Hash = Reader.ReadU64();
+		Event.USR = AtomTable::Intern(Reader.ReadString());
+		Event.IsMain = Reader.ReadBool();
+		Event.HasArgument = Reader.ReadBool();
+		Event.Pos = SourcePosition::Deserialize(Reader);
+		Event.NumOperators = Reader.ReadU32();
+		Event.Region = Reader.ReadU32();
+		Log.Events.push_back(Event);
+	}
+
+	return !Reader.HasFailed();
+}
+
+/**
+ * @brief Looks up the FunctionNode of a declaration or call event and registers the function if it is not known yet.
+ * Terminates if a different function with the same hash value has been registered before.
+ **/
+static FunctionNode* LookupFunction(PatternGraph* Graph, TUEvent& Event)
+{
+	FunctionNode* Func;
+
+	try{
+		Func = Graph->GetFunctionNode(Event.Hash, Event.USR);
+	}
+	catch(FunctionHashCollisionException& e){
+		std::cout << e.what();
+		throw TerminateEarlyException();
+	}
+
+	if (Func == NULL)
+	{
+		Graph->RegisterFunction(Event.Name, Event.Hash, Event.USR, Event.IsMain);
+		Func = Graph->GetFunctionNode(Event.Hash);
+	}
+
+	return Func;
+}
+
+void TranslationUnitLog::Replay(AnalysisSession* Session)
+{
+	PatternGraph* Graph = Session->GetGraph();
+	CallTree* ClTre = Session->GetCallTree();
+
+	HPCPatternBeginInstrHandler PatternBeginHandler(Session);
+	HPCPatternEndInstrHandler PatternEndHandler(Session);
+
+	FunctionNode* CurrentFnEntry = NULL;
+
+	// denotes which type of nodes we analyzed lastVisit
+	CallTreeNodeType LastNodeType = Function_Decl;
+
+	/* The code regions created for the pattern begins, in the order of the log */
+	std::vector<PatternCodeRegion*> BeginRegions;
+
+	for (TUEvent& Event : Events)
+	{
+		if (Event.Kind == TUE_FunctionDecl)
+		{
+			CallTreeNode* Node;
+
+			CurrentFnEntry = LookupFunction(Graph, Event);
+			if(Event.IsMain){
+				Node = ClTre->registerNode(Root, CurrentFnEntry, LastNodeType, Session->GetTopPatternStack(), CurrentFnEntry);
+				ClTre->setRootNode(Node);
+			}
+			else
+				Node = ClTre->registerNode(Function_Decl, CurrentFnEntry, LastNodeType, Session->GetTopPatternStack(), CurrentFnEntry);
+
+			Node->SetPosition(Event.Pos);
+			#ifdef LOCDEBUG
+				std::cout << "setted LineNumber of: "<< *Node->GetID()<<" to "<< Event.Pos.Line <<" verification: "<<Node->getLineNumber()<< '\n';
+			#endif
+		#ifdef PRINT_DEBUG
+			std::cout << CurrentFnEntry->GetFnName() << " (" << CurrentFnEntry->GetHash() << ")" << std::endl;
+		#endif
+
+			PatternBeginHandler.SetCurrentFnEntry(CurrentFnEntry);
+			PatternEndHandler.SetCurrentFnEntry(CurrentFnEntry);
+
+			LastNodeType = Function_Decl;
+		}
+		else if (Event.Kind == TUE_ForeignFunctionDecl)
+		{
+			LastNodeType = Function_Decl;
+		}
+		else if (Event.Kind == TUE_PatternBegin)
+		{
+			/* Running the handler creates the patternCodeRegion and if there is no mathing PatternOccurrence it
+			   is creating one. Also are the Child parent relations set and the Pattern is registered in the patternStack.*/
+			PatternCodeRegion* PatBeforethisPat = PatternBeginHandler.GetLastPattern();
+
+			if (Event.HasArgument)
+			{
+				PatternBeginHandler.run(Event.Name);
+			}
+
+			PatternCodeRegion* PatternCodeReg = PatternBeginHandler.GetLastPattern();
+
+			/* Store this PatternCodeRegion Begin in the CallTree (ClTre)*/
+			CallTreeNode* BeginNode = ClTre->registerNode(Pattern_Begin, PatternCodeReg, LastNodeType, PatBeforethisPat, CurrentFnEntry);
+
+			BeginNode->SetPosition(Event.Pos);
+			#ifdef LOCDEBUG
+				std::cout << "setted LineNumber of: "<< *BeginNode->GetID()<<" to "<< Event.Pos.Line <<" verification: "<<BeginNode->getLineNumber()<< '\n';
+			#endif
+			PatternCodeReg->SetFirstLine(Event.Pos.Line);
+			PatternCodeReg->SetStartPosition(Event.Pos);
+
+			/* The visitor only records instrumentation calls in the main file */
+			PatternCodeReg->isInMain = true;
+
+			BeginRegions.push_back(PatternCodeReg);
+
+			LastNodeType = Pattern_Begin;
+		}
+		else if (Event.Kind == TUE_PatternEnd)
+		{
+			PatternCodeRegion* PatternCodeReg;
+			try{
+				if (Event.HasArgument)
+				{
+					PatternEndHandler.run(Event.Name);
+				}
+				PatternCodeReg = PatternEndHandler.GetLastPattern();
+			}
+			catch(TooManyEndsException& e){
+				e.what();
+				throw TerminateEarlyException();
+			}
+
+			CallTreeNode* EndNode = ClTre->registerEndNode(Pattern_End, PatternEndHandler.GetLastPatternID(), LastNodeType, PatternCodeReg, CurrentFnEntry);
+			EndNode->SetPosition(Event.Pos);
+			if (Event.HasArgument && PatternCodeReg != NULL)
+			{
+				PatternCodeReg->SetEndPosition(Event.Pos);
+			}
+			#ifdef LOCDEBUG
+				std::cout << "setted LineNumber of: "<< *EndNode->GetID()<<" to "<< Event.Pos.Line <<" verification: "<<EndNode->getLineNumber()<< '\n';
+			#endif
+		}
+		else if (Event.Kind == TUE_HalsteadOperators)
+		{
+			/* The visitor records the operators of nested regions for each of them, also for nested regions of the same pattern */
+			if (Event.Region >= BeginRegions.size() || BeginRegions[Event.Region] == NULL)
+			{
+				continue;
+			}
+
+			HPCParallelPattern* Pattern = BeginRegions[Event.Region]->GetPatternOccurrence()->GetPattern();
+			Pattern->AddNumOfOperators(Event.NumOperators);
+
+			if (Halstead* HalsteadStatistic = Session->GetHalstead())
+			{
+				HalsteadStatistic->insertPattern(Pattern);
+			}
+		}
+		else if (Event.Kind == TUE_FunctionCall)
+		{
+			/* Look up the database entry for the function in which the current callExpr is within*/
+			FunctionNode* Func;
+
+			/*if the function is not registered register*/
+			Func = LookupFunction(Graph, Event);
+
+	#ifdef PRINT_DEBUG
+			std::cout << Func->GetFnName() << " (" << Func->GetHash() << ")" << std::endl;
+	#endif
+
+			/* Store this function call in the CallTree (ClTre)*/
+			CallTreeNode* FuncNode = ClTre->registerNode(Function, Func, LastNodeType, Session->GetTopPatternStack(), CurrentFnEntry);
+			FuncNode->SetPosition(Event.Pos);
+
+			PatternCodeRegion* Top;
+			/* if we are within a Pattern -> register this Functon as a child of the pattern etc. */
+			if ((Top = Session->GetTopPatternStack()) != NULL)
+			{
+				Top->AddChild(Func);
+				Func->AddParent(Top);
+
+				Func->AddPatternParent(Top);
+				#ifdef DEBUG_J
+				std::cout << Func->GetFnName()<< " hat als PatternParent: " << Top->GetID()<< '\n';
+				#endif
+			}
+			else
+			{/*if not register this function as a child for the function in which we currenty are
+				 (because we are always inside a function this is possible)
+				 */
+				CurrentFnEntry->AddChild(Func);
+				Func->AddParent(CurrentFnEntry);
+
+				/*if the parent of this function has a PatternParent, the function inherits it to its child (Func) */
+				if(!CurrentFnEntry->HasNoPatternParents()){
+					//function has PatternParents too
+					Func->AddPatternParents(CurrentFnEntry->GetPatternParents());
+					/*If the function has PatternParents AND PatternChildre, we register the the GetPatternChildren
+						as Children of the PatternParents vice versa*/
+					if(!Func->HasNoPatternChildren()){
+						Func->registerPatChildrenToPatParents();
+					}
+				}
+			}
+		}
+	}
+}
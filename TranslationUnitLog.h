@@ -0,0 +1,133 @@
+#pragma once
+
+#include "PatternGraph.h"
+#include "AnalysisSession.h"
+#include "Serialization.h"
+#include "SourcePosition.h"
+
+#include <string>
+#include <vector>
+
+
+
+/**
+ * The kinds of observations the HPCPatternInstrVisitor makes while traversing a translation unit.
+ */
+enum TUEventKind
+{
+	TUE_FunctionDecl, /*!< A function declaration in the main file. */
+	TUE_ForeignFunctionDecl, /*!< A function declaration outside of the main file. Only resets the type of the last visited node. */
+	TUE_FunctionCall, /*!< A call of a function that is not an instrumentation function. */
+	TUE_PatternBegin, /*!< A call of Pattern_Begin. */
+	TUE_PatternEnd, /*!< A call of Pattern_End. */
+	TUE_HalsteadOperators /*!< Operators of the Halstead metric within a pattern code region of the translation unit. */
+};
+
+/**
+ * A single observation of the HPCPatternInstrVisitor.
+ * It only contains data, so it stays valid after the AST of the translation unit has been released.
+ */
+struct TUEvent
+{
+	TUEventKind Kind;
+	/* The function name or the string argument of the instrumentation call */
+	std::string Name;
+	/* The hash value and the interned USR of the declared or called function */
+	uint64_t Hash = 0;
+	Atom USR = 0;
+	bool IsMain = false;
+	/* False if no string literal could be found in the argument of an instrumentation call */
+	bool HasArgument = false;
+	/* The position of the declaration or call */
+	SourcePosition Pos;
+	/* The number of Halstead operators and the number of the pattern begin of the translation unit they belong to */
+	int NumOperators = 0;
+	unsigned Region = 0;
+};
+
+/**
+ * The TranslationUnitLog records the facts the HPCPatternInstrVisitor extracts from one translation unit in the order in which they were encountered.
+ * The PatternGraph and the CallTree are only modified when the log is replayed.
+ * This allows the parsing and traversal of translation units on worker threads, while the AnalysisSession is still built in a deterministic order.
+ */
+class TranslationUnitLog
+{
+public:
+	TranslationUnitLog(std::string SourceFile);
+
+	void AddFunctionDecl(std::string Name, uint64_t Hash, Atom USR, bool IsMain, SourcePosition Pos);
+
+	void AddForeignFunctionDecl();
+
+	void AddFunctionCall(std::string Name, uint64_t Hash, Atom USR, bool IsMain, SourcePosition Pos);
+
+	void AddPatternBegin(bool HasArgument, std::string Argument, SourcePosition Pos);
+
+	void AddPatternEnd(bool HasArgument, std::string Argument, SourcePosition Pos);
+
+	/**
+	 * @brief Records the Halstead operators within a pattern code region.
+	 *
+	 * @param Region The number of the pattern begin in this log, starting with 0 for the first one.
+	 * @param NumOperators The number of operators.
+	 **/
+	void AddHalsteadOperators(unsigned Region, int NumOperators);
+
+	/**
+	 * @brief Applies the recorded facts to the PatternGraph and the CallTree of a session.
+	 * This creates the same objects and relations as if the PatternGraph and the CallTree were modified during the traversal.
+	 *
+	 * @param Session The session of the analysis.
+	 **/
+	void Replay(AnalysisSession* Session);
+
+	/**
+	 * @brief Records a file (the main file or a header) the translation unit was built from.
+	 *
+	 * @param Path The absolute path of the file.
+	 **/
+	void AddDependency(std::string Path);
+
+	std::string GetSourceFile() { return SourceFile; }
+
+	std::vector<std::string>& GetDependencies() { return Dependencies; }
+
+	std::vector<TUEvent>& GetEvents() { return Events; }
+
+	/**
+	 * @brief Sets the container in which the logs of the translation units analysed by the calling thread are collected.
+	 * If no container is set (the default), the log is replayed immediately after the traversal.
+	 *
+	 * @param Sink The container or NULL.
+	 **/
+	static void SetThreadSink(std::vector<TranslationUnitLog>* Sink);
+
+	static std::vector<TranslationUnitLog>* GetThreadSink();
+
+	/**
+	 * @brief Writes the log with all events and dependencies.
+	 *
+	 * @param Writer The writer.
+	 **/
+	void Serialize(BinaryWriter& Writer);
+
+	/**
+	 * @brief Reads a log written by Serialize().
+	 *
+	 * @param Reader The reader.
+	 * @param Log The log the events and dependencies are appended to.
+	 *
+	 * @return False if the data is incomplete or corrupt.
+	 **/
+	static bool Deserialize(BinaryReader& Reader, TranslationUnitLog& Log);
+
+private:
+	std::string SourceFile;
+
+	std::vector<TUEvent> Events;
+
+	std::vector<std::string> Dependencies;
+
+	/* Used to skip foreign function declarations which would not change the state of the replay */
+	bool LastVisitedIsPatternBegin = false;
+};
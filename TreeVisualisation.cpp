@@ -7,13 +7,14 @@
  * @brief Prints the call tree recursively, beginning with the main function.
  *
  * @param maxdepth The maximum recursion (i.e., output depth)
+ * @param Graph The graph of the analysis.
  **/
-void CallTreeVisualisation::PrintRelationTree(int maxdepth, bool onlyPattern)
+void CallTreeVisualisation::PrintRelationTree(int maxdepth, PatternGraph* Graph, bool onlyPattern)
 {
 	std::cout << "\n RELATION TREE VISUALISATION \n";
-	PatternGraphNode* RootNode = PatternGraph::GetInstance()->GetRootNode();
+	PatternGraphNode* RootNode = Graph->GetRootNode();
 	if(onlyPattern){
-			PrintOnlyPatternTree(maxdepth);
+			PrintOnlyPatternTree(maxdepth, Graph);
 	}
 	else{
 		if (FunctionNode* Func = clang::dyn_cast<FunctionNode>(RootNode))
@@ -42,11 +43,11 @@ void CallTreeVisualisation::PrintCallTree(int maxdepth, CallTree* CalTre, bool o
 	PrintCallTreeRecursively (CallTreeHelpKey, CallTreeHelp, currentNode, 0, maxdepth, onlyPattern);
 }
 
-void CallTreeVisualisation::PrintOnlyPatternTree(int maxdepth)
+void CallTreeVisualisation::PrintOnlyPatternTree(int maxdepth, PatternGraph* Graph)
 {
-	//PatternGraph::GetInstance()->SetOnlyPatternRootNodes();
+	//Graph->SetOnlyPatternRootNodes();
 
-	for(PatternCodeRegion* OnlyPatRootNode : PatternGraph::GetInstance()->GetAllPatternCodeRegions())
+	for(PatternCodeRegion* OnlyPatRootNode : Graph->GetAllPatternCodeRegions())
 	//hier selbst raussortieren welche Pattern als RootNode gelten(Pattern die in der Main sind und keine Eltern haben)
 	{
 #ifdef DEBUG
@@ -62,7 +63,7 @@ void CallTreeVisualisation::PrintOnlyPatternTree(int maxdepth)
 	}
 
 #ifdef DEBUG
-	for(FunctionNode* FuncNode : PatternGraph::GetInstance()->GetAllFunctions())
+	for(FunctionNode* FuncNode : Graph->GetAllFunctions())
 	{
 		if(!FuncNode->HasNoPatternParents()||!FuncNode->HasNoPatternChildren())
 		std::cout << "NEUE FUNKTION" << '\n';
@@ -198,13 +199,12 @@ void CallTreeVisualisation::PrintCallTreeRecursively(int &HelpKey, std::vector<s
 		if(ClTrNode->GetCaller())
 			std::cout << "Caller:" << *(ClTrNode->GetCaller()->GetID())<<" Type: "<< ClTrNode->GetCaller()->GetNodeType() << std::endl;
 		  std::cout << "Callees:" << std::endl;
-			for(CallTreeNode* Callee : *ClTrNode->GetCallees())
+			for(CallTreeNode* Callee : ClTrNode->GetCallees())
 			{
 				std::cout << *Callee->GetID() << " Type: " << Callee->GetNodeType() << std::endl;
 			}
 	#endif
-	for(const auto &CalleePair : *(ClTrNode->GetCallees())){
-		CallTreeNode* Callee = CalleePair.second;
+	for(CallTreeNode* Callee : ClTrNode->GetCallees()){
 		if(nodeTypeOfClTr == Function_Decl){
 				PrintCallTreeRecursively(HelpKey, CallTreeHelp, Callee, depth, maxdepth, onlyPattern);
 		}
@@ -14,7 +14,7 @@ public:
 	/**
 		* Prints the relation Tree
 		**/
-	static void PrintRelationTree(int maxdepth, bool onlyPattern);
+	static void PrintRelationTree(int maxdepth, PatternGraph* Graph, bool onlyPattern);
 	/**
 		* Prints the CallTree
 		**/
@@ -24,7 +24,7 @@ private:
 	/**
 		* Prints the OnlyPatterntree and is called from PrintRelationTree.
 		**/
-	static void PrintOnlyPatternTree(int maxdepth);
+	static void PrintOnlyPatternTree(int maxdepth, PatternGraph* Graph);
 	/**
 		* Prints a Pattern
 		**/